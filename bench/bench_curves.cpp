@@ -0,0 +1,134 @@
+// Compares drawing predicted curves segment by segment with ImDrawList::AddLine, as the GUIs used
+// to, against CurveRenderer, and writes the vertex and index counts and the build time of each as
+// JSON. Runs without a window: the draw list is built on shared data from a font atlas baked on
+// the CPU, so the anti-aliased line path is the one a GUI takes.
+
+#include "curve_renderer.hpp"
+
+#include <imgui.h>
+#include <imgui_internal.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+
+const float CANVAS_WIDTH = 1280;
+const float CANVAS_HEIGHT = 720;
+const vector<int> SAMPLE_COUNTS = {100, 1000, 10000, 100000, 1000000};
+
+/// a smooth curve across the canvas, with noise of amplitude noise pixels
+vector<Point> make_curve(int n, float noise)
+{
+    mt19937 engine{102};
+    uniform_real_distribution<float> jitter{-noise, noise};
+    vector<Point> xy(n);
+    for (int i = 0; i < n; i++) {
+        float x = CANVAS_WIDTH * i / (n - 1);
+        xy[i] = {x, CANVAS_HEIGHT / 2 + 200 * std::sin(x / 80) + jitter(engine)};
+    }
+    return xy;
+}
+
+struct Result
+{
+    int vertices;
+    int indices;
+    double ms; // per curve, the least of the repeats
+};
+
+/// Builds the curve into a fresh draw list repeat times with draw(list)
+template <typename Draw>
+Result measure(const ImDrawListSharedData& shared, int repeat, Draw&& draw)
+{
+    ImDrawList list(&shared);
+    Result result{0, 0, 1e300};
+    for (int r = 0; r < repeat; r++) {
+        list._ResetForNewFrame();
+        list.PushClipRect({0, 0}, {CANVAS_WIDTH, CANVAS_HEIGHT});
+        auto beg = chrono::steady_clock::now();
+        draw(list);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - beg).count();
+        result.ms = std::min(result.ms, ms);
+        result.vertices = list.VtxBuffer.Size;
+        result.indices = list.IdxBuffer.Size;
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc > 2 || (argc == 2 && argv[1][0] == '-')) {
+        fprintf(stderr, "usage: bench_curves [output.json]\n");
+        return 2;
+    }
+
+    ImFontAtlas atlas;
+    atlas.AddFontDefault();
+    atlas.Build();
+
+    ImDrawListSharedData shared;
+    shared.TexUvWhitePixel = atlas.TexUvWhitePixel;
+    shared.TexUvLines = atlas.TexUvLines;
+    shared.ClipRectFullscreen = {0, 0, CANVAS_WIDTH, CANVAS_HEIGHT};
+    shared.InitialFlags = ImDrawListFlags_AntiAliasedLines |
+                          ImDrawListFlags_AntiAliasedLinesUseTex |
+                          ImDrawListFlags_AntiAliasedFill | ImDrawListFlags_AllowVtxOffset;
+
+    FILE* out = stdout;
+    if (argc == 2) {
+        out = fopen(argv[1], "w");
+        if (!out) {
+            fprintf(stderr, "bench_curves: cannot open %s\n", argv[1]);
+            return 1;
+        }
+    }
+
+    fprintf(out, "{\n  \"benchmark\": \"bench_curves\",\n  \"canvas_width\": %g,\n", CANVAS_WIDTH);
+    fprintf(out, "  \"results\": [");
+    bool first = true;
+    for (float noise : {0.0f, 20.0f}) {
+        for (int n : SAMPLE_COUNTS) {
+            auto xy = make_curve(n, noise);
+            const int repeat = n <= 10000 ? 50 : 5;
+            const ImVec2 origin{0, 0};
+            const ImU32 color = IM_COL32(128, 255, 255, 255);
+
+            Result lines = measure(shared, repeat, [&](ImDrawList& list) {
+                for (int i = 1; i < n; i++) {
+                    list.AddLine({origin.x + xy[i - 1].x, origin.y + xy[i - 1].y},
+                                 {origin.x + xy[i].x, origin.y + xy[i].y}, color, 2.0f);
+                }
+            });
+            CurveRenderer renderer;
+            Result curve = measure(shared, repeat, [&](ImDrawList& list) {
+                renderer.draw(&list, origin, xy, color);
+            });
+
+            for (auto [method, r] : {pair{"AddLine", lines}, pair{"CurveRenderer", curve}}) {
+                fprintf(out,
+                        "%s\n    {\"method\": \"%s\", \"samples\": %d, \"noise\": %g, "
+                        "\"vertices\": %d, \"indices\": %d, \"ms\": %.6g}",
+                        first ? "" : ",", method, n, noise, r.vertices, r.indices, r.ms);
+                first = false;
+            }
+            fprintf(stderr, "samples %7d noise %2g: AddLine %8d vtx %9.4f ms, CurveRenderer %6d vtx "
+                            "%8.4f ms, %d points drawn\n",
+                    n, noise, lines.vertices, lines.ms, curve.vertices, curve.ms,
+                    renderer.draw_stats().drawn_points / repeat);
+        }
+    }
+    fprintf(out, "\n  ]\n}\n");
+    if (out != stdout)
+        fclose(out);
+}
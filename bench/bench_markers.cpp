@@ -0,0 +1,135 @@
+// Compares drawing the points one ImDrawList::AddCircleFilled at a time, as the GUIs used to,
+// against one ImDrawList::AddMarkers batch, and writes the vertex and index counts and the build
+// time of each as JSON. The points are spread over twice the canvas width, so that half of them
+// are clipped, and over the canvas height. Runs without a window, as bench_curves does.
+
+#include <imgui.h>
+#include <imgui_internal.h>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+
+const float CANVAS_WIDTH = 1280;
+const float CANVAS_HEIGHT = 720;
+const vector<int> POINT_COUNTS = {100, 1000, 10000, 100000, 1000000};
+
+vector<ImVec2> make_points(int n)
+{
+    mt19937 engine{102};
+    uniform_real_distribution<float> x{-CANVAS_WIDTH / 2, CANVAS_WIDTH * 3 / 2};
+    uniform_real_distribution<float> y{0, CANVAS_HEIGHT};
+    vector<ImVec2> points(n);
+    for (auto& p : points) {
+        p = {x(engine), y(engine)};
+    }
+    return points;
+}
+
+struct Result
+{
+    int vertices;
+    int indices;
+    double ms; // the least of the repeats
+};
+
+/// Builds the markers into a fresh draw list repeat times with draw(list)
+template <typename Draw>
+Result measure(const ImDrawListSharedData& shared, int repeat, Draw&& draw)
+{
+    ImDrawList list(&shared);
+    Result result{0, 0, 1e300};
+    for (int r = 0; r < repeat; r++) {
+        list._ResetForNewFrame();
+        list.PushClipRect({0, 0}, {CANVAS_WIDTH, CANVAS_HEIGHT});
+        auto beg = chrono::steady_clock::now();
+        draw(list);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - beg).count();
+        result.ms = std::min(result.ms, ms);
+        result.vertices = list.VtxBuffer.Size;
+        result.indices = list.IdxBuffer.Size;
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc > 2 || (argc == 2 && argv[1][0] == '-')) {
+        fprintf(stderr, "usage: bench_markers [output.json]\n");
+        return 2;
+    }
+
+    ImFontAtlas atlas;
+    atlas.AddFontDefault();
+    atlas.Build();
+
+    ImDrawListSharedData shared;
+    shared.TexUvWhitePixel = atlas.TexUvWhitePixel;
+    shared.TexUvLines = atlas.TexUvLines;
+    shared.ClipRectFullscreen = {0, 0, CANVAS_WIDTH, CANVAS_HEIGHT};
+    shared.SetCircleSegmentMaxError(ImGuiStyle().CircleSegmentMaxError);
+    shared.InitialFlags = ImDrawListFlags_AntiAliasedLines |
+                          ImDrawListFlags_AntiAliasedLinesUseTex |
+                          ImDrawListFlags_AntiAliasedFill | ImDrawListFlags_AllowVtxOffset;
+
+    FILE* out = stdout;
+    if (argc == 2) {
+        out = fopen(argv[1], "w");
+        if (!out) {
+            fprintf(stderr, "bench_markers: cannot open %s\n", argv[1]);
+            return 1;
+        }
+    }
+
+    const float radius = 5;
+    const ImU32 color = IM_COL32(255, 100, 100, 255);
+    const ImVec2 origin{0, 0};
+
+    fprintf(out, "{\n  \"benchmark\": \"bench_markers\",\n  \"radius\": %g,\n", radius);
+    fprintf(out, "  \"results\": [");
+    bool first = true;
+    for (int n : POINT_COUNTS) {
+        auto points = make_points(n);
+        const int repeat = n <= 10000 ? 50 : 5;
+
+        Result circles = measure(shared, repeat, [&](ImDrawList& list) {
+            for (const auto& p : points) {
+                list.AddCircleFilled({origin.x + p.x, origin.y + p.y}, radius, color);
+            }
+        });
+        Result markers = measure(shared, repeat, [&](ImDrawList& list) {
+            list.AddMarkers(points.data(), n, origin, radius, color);
+        });
+        Result lod = measure(shared, repeat, [&](ImDrawList& list) {
+            list.AddMarkers(points.data(), n, origin, radius, color,
+                            ImDrawMarkerFlags_SquareWhenDense);
+        });
+
+        for (auto [method, r] : {pair{"AddCircleFilled", circles}, pair{"AddMarkers", markers},
+                                 pair{"AddMarkers SquareWhenDense", lod}}) {
+            fprintf(out,
+                    "%s\n    {\"method\": \"%s\", \"points\": %d, \"vertices\": %d, "
+                    "\"indices\": %d, \"ms\": %.6g}",
+                    first ? "" : ",", method, n, r.vertices, r.indices, r.ms);
+            first = false;
+        }
+        fprintf(stderr,
+                "points %7d: AddCircleFilled %8d vtx %9.4f ms, AddMarkers %8d vtx %8.4f ms, "
+                "SquareWhenDense %8d vtx %8.4f ms\n",
+                n, circles.vertices, circles.ms, markers.vertices, markers.ms, lod.vertices,
+                lod.ms);
+    }
+    fprintf(out, "\n  ]\n}\n");
+    if (out != stdout)
+        fclose(out);
+}
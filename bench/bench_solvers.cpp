@@ -0,0 +1,480 @@
+// Times the fit and predict of the solvers of hw1 and hw2, and the update steps of the optimizers
+// of hw2, over a sweep of problem sizes and writes the results as JSON to compare commits by.
+//
+// The data sets are drawn from a fixed seed. Every case runs once to warm up and is then repeated
+// in batches until a batch has taken at least --min-time milliseconds. Heap allocations are counted
+// by interposing malloc where glibc allows it, which catches the buffers of Eigen as well, and by
+// replacing operator new elsewhere. The "alloc_hook" field of the output says which one was counted.
+
+#include "hw1/solve.hpp"
+#include "hw2/solve.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+
+atomic<uint64_t> heap_allocs{0};
+atomic<uint64_t> heap_bytes{0};
+
+void count_alloc(size_t size)
+{
+    heap_allocs.fetch_add(1, memory_order_relaxed);
+    heap_bytes.fetch_add(size, memory_order_relaxed);
+}
+
+} // namespace
+
+#if defined(__GLIBC__)
+
+const char* ALLOC_HOOK = "malloc";
+
+extern "C"
+{
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+
+void* malloc(size_t size) noexcept
+{
+    count_alloc(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept
+{
+    count_alloc(count * size);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) noexcept
+{
+    count_alloc(size);
+    return __libc_realloc(ptr, size);
+}
+}
+
+#else
+
+const char* ALLOC_HOOK = "operator new";
+
+void* operator new(size_t size)
+{
+    count_alloc(size);
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+#endif
+
+namespace
+{
+
+const char* USAGE = R"(usage: bench_solvers [options]
+
+Benchmarks the solvers of hw1 and hw2 and writes the results as JSON.
+
+options:
+  -o FILE            write the JSON to FILE instead of stdout
+  --filter TEXT      only run the cases whose name contains TEXT
+  --max-points N     the largest point or sample count of the sweeps, 1000000 by default
+  --min-time MS      the least time every case is repeated for, 100 by default
+  --seed N           the seed of the data sets, 102 by default
+  -h, --help         show this help
+)";
+
+using Clock = chrono::steady_clock;
+
+const float X_START = 0;
+const float X_END = 1000;
+const int FIT_POINTS = 100; // the points the solvers of the predict cases are fitted to
+const int MAX_REPEAT = 1000000;
+
+/// the largest point counts the dense solvers and the RBF network are fitted to
+const int MAX_DENSE_POINTS = 1000;
+const int MAX_RBF_POINTS = 1000;
+
+const vector<int> POINT_COUNTS = {10, 100, 1000, 10000, 100000, 1000000};
+const vector<int> SAMPLE_COUNTS = {10, 100, 1000, 10000, 100000, 1000000};
+const vector<int> ORDERS = {1, 3, 7, 15};
+const vector<int> BASIS_COUNTS = {4, 16, 64};
+const vector<int> PARAM_BASIS_COUNTS = {4, 16, 64, 256, 1024, 4096};
+
+struct Options
+{
+    string output;
+    string filter;
+    int max_points{1000000};
+    double min_time_ms{100};
+    uint32_t seed{102};
+};
+
+/// the named sizes of a case, such as the number of points and the order
+using Params = vector<pair<const char*, long long>>;
+
+struct Measurement
+{
+    string name;
+    Params params;
+    long long items; // processed per call, the points of a fit or the samples of a predict
+    int repeat;      // timed calls
+    double ns;       // per call
+    double allocs;   // heap allocations per call
+    double bytes;    // heap bytes allocated per call
+};
+
+volatile float sink; // keeps the results of the timed calls alive
+
+void keep(float value)
+{
+    sink = value;
+}
+
+void keep(const vector<Point>& points)
+{
+    keep(points.empty() ? 0 : points.back().y);
+}
+
+/// Points over [X_START, X_END] jittered around a uniform grid, so that the xs are distinct and
+/// ascending, with a noisy smooth function as the ys
+vector<Point> make_points(int n, uint32_t seed)
+{
+    mt19937 engine{seed};
+    uniform_real_distribution<float> jitter{-0.4f, 0.4f};
+    normal_distribution<float> noise{0, 5};
+
+    vector<Point> points(n);
+    const float step = (X_END - X_START) / n;
+    for (int i = 0; i < n; i++) {
+        float x = X_START + (i + 0.5f + jitter(engine)) * step;
+        points[i] = {x, 300 + 100 * std::sin(x / 80) + noise(engine)};
+    }
+    return points;
+}
+
+class Bench
+{
+public:
+    explicit Bench(const Options& opts)
+        : opts{opts}
+    {
+    }
+
+    /// Times call, which processes items points or samples, unless the filter excludes name
+    template <typename F>
+    void run(const string& name, Params params, long long items, F&& call)
+    {
+        if (name.find(opts.filter) == string::npos) {
+            return;
+        }
+
+        call(); // warm up, the first call pays for caches, page faults and lazy allocations
+
+        // batches grow from the time per call of the last one until a batch takes min_time_ms
+        const double min_ns = opts.min_time_ms * 1e6;
+        int repeat = 1;
+        uint64_t allocs = 0;
+        uint64_t bytes = 0;
+        double ns = 0;
+        for (;;) {
+            allocs = heap_allocs.load();
+            bytes = heap_bytes.load();
+            auto beg = Clock::now();
+            for (int i = 0; i < repeat; i++) {
+                call();
+            }
+            ns = chrono::duration<double, nano>(Clock::now() - beg).count();
+            if (ns >= min_ns || repeat >= MAX_REPEAT) {
+                break;
+            }
+            // aim 10% past min_time_ms, but at least double, as a short batch times poorly
+            double next = std::ceil(1.1 * min_ns / std::max(ns / repeat, 1.0));
+            repeat = static_cast<int>(
+                std::min(std::max(next, 2.0 * repeat), static_cast<double>(MAX_REPEAT)));
+        }
+
+        double call_allocs = static_cast<double>(heap_allocs.load() - allocs) / repeat;
+        double call_bytes = static_cast<double>(heap_bytes.load() - bytes) / repeat;
+        Measurement m{name, std::move(params), items, repeat, ns / repeat, call_allocs, call_bytes};
+
+        fprintf(stderr, "%-36s", m.name.c_str());
+        for (const auto& [key, value] : m.params) {
+            fprintf(stderr, " %s=%lld", key, value);
+        }
+        fprintf(stderr, ": %.4g ms, %.4g allocs\n", m.ns * 1e-6, m.allocs);
+        results.push_back(std::move(m));
+    }
+
+    void write_json(FILE* out) const
+    {
+        fprintf(out, "{\n  \"benchmark\": \"bench_solvers\",\n  \"seed\": %u,\n", opts.seed);
+        fprintf(out, "  \"min_time_ms\": %g,\n  \"alloc_hook\": \"%s\",\n", opts.min_time_ms,
+                ALLOC_HOOK);
+        fprintf(out, "  \"results\": [");
+        for (size_t i = 0; i < results.size(); i++) {
+            const auto& m = results[i];
+            fprintf(out, "%s\n    {\"name\": \"%s\", \"params\": {", i ? "," : "", m.name.c_str());
+            for (size_t k = 0; k < m.params.size(); k++) {
+                fprintf(out, "%s\"%s\": %lld", k ? ", " : "", m.params[k].first,
+                        m.params[k].second);
+            }
+            fprintf(out,
+                    "}, \"repeat\": %d, \"ns_per_call\": %.6g, \"calls_per_s\": %.6g, "
+                    "\"items_per_s\": %.6g, \"allocs_per_call\": %.6g, \"bytes_per_call\": %.6g}",
+                    m.repeat, m.ns, 1e9 / m.ns, m.items * 1e9 / m.ns, m.allocs, m.bytes);
+        }
+        fprintf(out, "\n  ]\n}\n");
+    }
+
+    const Options& opts;
+
+private:
+    vector<Measurement> results;
+};
+
+vector<int> up_to(const vector<int>& counts, int max_count)
+{
+    vector<int> kept;
+    for (int n : counts) {
+        if (n <= max_count)
+            kept.push_back(n);
+    }
+    return kept;
+}
+
+RBFNetwork fit_network(int num_basis, const vector<Point>& points)
+{
+    RBFNetwork net(num_basis);
+    net.verbose = false;
+    net.fit(make_shared<AdamOptimizer>(0.1f), points);
+    return net;
+}
+
+void bench_fits(Bench& bench)
+{
+    const auto& opts = bench.opts;
+    for (int n : up_to(POINT_COUNTS, opts.max_points)) {
+        auto points = make_points(n, opts.seed);
+
+        if (n <= MAX_DENSE_POINTS) {
+            bench.run("MonomialInterpolation", {{"points", n}}, n, [&] {
+                MonomialInterpolation mi(points);
+                keep(mi.coeff(0));
+            });
+            bench.run("GaussInterpolation", {{"points", n}}, n, [&] {
+                GaussInterpolation gi(33, points);
+                keep(gi.coeff(0));
+            });
+        }
+
+        for (int m : ORDERS) {
+            bench.run("LeastSquare", {{"points", n}, {"order", m}}, n, [&] {
+                LeastSquare ls(m, points);
+                keep(ls.coeff(0));
+            });
+            bench.run("RidgeRegression", {{"points", n}, {"order", m}}, n, [&] {
+                RidgeRegression rr(m, 0.01f, points);
+                keep(rr.coeff(0));
+            });
+            bench.run("BasicLeastSquare<float>", {{"points", n}, {"order", m}}, n, [&] {
+                BasicLeastSquare<float> ls(m, points);
+                keep(ls.coeff(0));
+            });
+        }
+
+        if (n <= MAX_RBF_POINTS) {
+            for (int b : BASIS_COUNTS) {
+                bench.run("RBFNetwork::fit", {{"points", n}, {"basis", b}}, n,
+                          [&] { keep(fit_network(b, points).w2(0, 0)); });
+            }
+        }
+    }
+}
+
+void bench_predicts(Bench& bench)
+{
+    const auto& opts = bench.opts;
+    auto points = make_points(FIT_POINTS, opts.seed);
+
+    MonomialInterpolation mi(points);
+    GaussInterpolation gi(33, points);
+    vector<pair<int, LeastSquare>> least_squares;
+    vector<pair<int, RidgeRegression>> ridges;
+    for (int m : ORDERS) {
+        least_squares.emplace_back(m, LeastSquare(m, points));
+        ridges.emplace_back(m, RidgeRegression(m, 0.01f, points));
+    }
+    vector<pair<int, RBFNetwork>> networks;
+    for (int b : BASIS_COUNTS) {
+        networks.emplace_back(b, fit_network(b, points));
+    }
+
+    for (int s : up_to(SAMPLE_COUNTS, opts.max_points)) {
+        bench.run("MonomialInterpolation::predict", {{"points", FIT_POINTS}, {"samples", s}}, s,
+                  [&] { keep(mi.predict(X_START, X_END, s)); });
+        bench.run("GaussInterpolation::predict", {{"points", FIT_POINTS}, {"samples", s}}, s,
+                  [&] { keep(gi.predict(X_START, X_END, s)); });
+        for (auto& [m, ls] : least_squares) {
+            bench.run("LeastSquare::predict", {{"order", m}, {"samples", s}}, s,
+                      [&] { keep(ls.predict(X_START, X_END, s)); });
+        }
+        for (auto& [m, rr] : ridges) {
+            bench.run("RidgeRegression::predict", {{"order", m}, {"samples", s}}, s,
+                      [&] { keep(rr.predict(X_START, X_END, s)); });
+        }
+        for (auto& [b, net] : networks) {
+            bench.run("RBFNetwork::predict", {{"basis", b}, {"samples", s}}, s,
+                      [&] { keep(net.predict(X_START, X_END, s)); });
+        }
+    }
+}
+
+/// Steps opt on parameters shaped like those of an RBFNetwork of num_basis
+void bench_optimizer(Bench& bench, const string& name, Optimizer& opt, int num_basis)
+{
+    mt19937 engine{bench.opts.seed};
+    normal_distribution<float> rand{};
+    auto random = [&](int rows, int cols) {
+        return Matrixf(Matrixf::NullaryExpr(rows, cols, [&] { return rand(engine); }));
+    };
+
+    Matrixf w1 = random(1, num_basis);
+    Matrixf b1 = random(1, num_basis);
+    Matrixf w2 = random(num_basis, 1);
+    Matrixf b2 = random(1, 1);
+    vector<Matrixf*> params{&w1, &b1, &w2, &b2};
+    vector<Matrixf> grads{random(1, num_basis), random(1, num_basis), random(num_basis, 1),
+                          random(1, 1)};
+    opt.init_state(params);
+
+    const long long num_params = 3LL * num_basis + 1;
+    bench.run(name, {{"basis", num_basis}, {"params", num_params}}, num_params, [&] {
+        opt.update_params(params, grads);
+        keep(b2(0, 0));
+    });
+}
+
+void bench_optimizers(Bench& bench)
+{
+    for (int b : PARAM_BASIS_COUNTS) {
+        SgdOptimizer sgd(0.01f);
+        bench_optimizer(bench, "SgdOptimizer::update_params", sgd, b);
+        AdamOptimizer adam(0.01f);
+        bench_optimizer(bench, "AdamOptimizer::update_params", adam, b);
+    }
+}
+
+[[noreturn]] void usage_error(const string& message)
+{
+    fprintf(stderr, "bench_solvers: %s\n\n%s", message.c_str(), USAGE);
+    exit(2);
+}
+
+Options parse_args(int argc, char** argv)
+{
+    Options opts;
+    auto value = [&](int& i) -> string {
+        if (i + 1 >= argc)
+            usage_error(string(argv[i]) + " needs a value");
+        return argv[++i];
+    };
+    auto number = [&](int& i) {
+        string arg = argv[i];
+        string text = value(i);
+        char* end = nullptr;
+        double parsed = strtod(text.c_str(), &end);
+        if (end == text.c_str() || *end != '\0' || parsed < 0)
+            usage_error(arg + " needs a non-negative number");
+        return parsed;
+    };
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "-o") {
+            opts.output = value(i);
+        }
+        else if (arg == "--filter") {
+            opts.filter = value(i);
+        }
+        else if (arg == "--max-points") {
+            opts.max_points = static_cast<int>(number(i));
+        }
+        else if (arg == "--min-time") {
+            opts.min_time_ms = number(i);
+        }
+        else if (arg == "--seed") {
+            opts.seed = static_cast<uint32_t>(number(i));
+        }
+        else if (arg == "-h" || arg == "--help") {
+            fputs(USAGE, stdout);
+            exit(0);
+        }
+        else {
+            usage_error("unknown option " + arg);
+        }
+    }
+    return opts;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options opts = parse_args(argc, argv);
+    Bench bench(opts);
+
+    bench_fits(bench);
+    bench_predicts(bench);
+    bench_optimizers(bench);
+
+    FILE* out = stdout;
+    if (!opts.output.empty()) {
+        out = fopen(opts.output.c_str(), "w");
+        if (!out) {
+            fprintf(stderr, "bench_solvers: cannot open %s\n", opts.output.c_str());
+            return 1;
+        }
+    }
+    bench.write_json(out);
+    if (out != stdout)
+        fclose(out);
+}
@@ -0,0 +1,274 @@
+// Runs the DrawImGUI() frames of a GUI without a window: ImGui gets a fixed display size and time
+// step instead of GLFW's, and the draw data is rendered by the software rasterizer of
+// imgui_impl_soft. Built once per GUI, as hw1_headless and hw2_headless, it times the frames as
+// JSON and can write the last one as an image, so that frame cost and output can be checked on a
+// machine without a GPU or a display.
+
+#include "gui.hpp"
+#include "point_file.hpp"
+#include "profiler.hpp"
+
+#include <imgui.h>
+#include <imgui_impl_soft.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace
+{
+
+const char* USAGE = R"(usage: %s [options] [points.bin]
+
+Draws frames of the GUI headless and writes their timings as JSON.
+
+  --frames N     frames to time, after the background jobs of the first one settle (default 100)
+  --size WxH     display size (default 1280x720)
+  --threads N    rasterizer threads, 0 for one per hardware thread (default 0)
+  --points N     start from N generated points instead of a point file
+  --seed S       seed of the generated points (default 102)
+  --image PATH   write the last frame as a binary PPM
+  -o PATH        write the JSON to PATH instead of stdout
+)";
+
+struct Options
+{
+    int frames{100};
+    int width{1280};
+    int height{720};
+    int threads{0};
+    int points{0};
+    unsigned seed{102};
+    string point_file;
+    string image;
+    string output;
+};
+
+bool parse_options(int argc, char** argv, Options& opts)
+{
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        auto value = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+        const char* v = nullptr;
+        if (arg == "--frames" && (v = value())) {
+            opts.frames = atoi(v);
+        }
+        else if (arg == "--size" && (v = value())) {
+            if (sscanf(v, "%dx%d", &opts.width, &opts.height) != 2) {
+                return false;
+            }
+        }
+        else if (arg == "--threads" && (v = value())) {
+            opts.threads = atoi(v);
+        }
+        else if (arg == "--points" && (v = value())) {
+            opts.points = atoi(v);
+        }
+        else if (arg == "--seed" && (v = value())) {
+            opts.seed = static_cast<unsigned>(strtoul(v, nullptr, 10));
+        }
+        else if (arg == "--image" && (v = value())) {
+            opts.image = v;
+        }
+        else if (arg == "-o" && (v = value())) {
+            opts.output = v;
+        }
+        else if (arg[0] != '-' && opts.point_file.empty()) {
+            opts.point_file = arg;
+        }
+        else {
+            return false;
+        }
+    }
+    return opts.frames > 0 && opts.width > 0 && opts.height > 0 && opts.points >= 0;
+}
+
+/// n points along a noisy sine across the canvas, written to a temporary point file of this process
+string generate_points(int n, unsigned seed, float width, float height, string& error)
+{
+    mt19937 engine{seed};
+    uniform_real_distribution<float> x{0, width * 0.6f};
+    normal_distribution<float> noise{0, height * 0.03f};
+    vector<Point> points(n);
+    for (auto& p : points) {
+        p.x = x(engine);
+        p.y = height * 0.4f + height * 0.2f * std::sin(p.x / 80) + noise(engine);
+    }
+#if defined(_WIN32)
+    const int pid = _getpid();
+#else
+    const int pid = static_cast<int>(getpid());
+#endif
+    auto name = "headless_frames_points_" + to_string(pid) + ".bin";
+    auto path = (filesystem::temp_directory_path() / name).string();
+    return write_point_file<float>(path, points, false, error) ? path : string();
+}
+
+/// A fixed layout for the windows of the GUIs, the canvas filling most of the display
+string window_layout(int width, int height)
+{
+    const int side = 300; // width of the column of the points and profiler windows
+    char ini[512];
+    snprintf(ini, sizeof(ini),
+             "[Window][Points]\nPos=8,8\nSize=%d,%d\nCollapsed=0\n\n"
+             "[Window][Profiler]\nPos=8,%d\nSize=%d,%d\nCollapsed=1\n\n"
+             "[Window][Canvas]\nPos=%d,8\nSize=%d,%d\nCollapsed=0\n\n",
+             side, height / 2, height / 2 + 16, side, height / 2 - 24, side + 16,
+             width - side - 24, height - 16);
+    return ini;
+}
+
+/// Draws a frame and returns the ms spent in DrawImGUI() and in the rasterizer
+pair<double, double> draw_frame()
+{
+    auto beg = chrono::steady_clock::now();
+    ImGui_ImplSoft_NewFrame();
+    DrawImGUI();
+    auto mid = chrono::steady_clock::now();
+    {
+        PROFILE_SCOPE("ImGui_ImplSoft_RenderDrawData");
+        ImGui_ImplSoft_RenderDrawData(ImGui::GetDrawData(), IM_COL32(115, 140, 153, 255));
+    }
+    auto end = chrono::steady_clock::now();
+    return {chrono::duration<double, milli>(mid - beg).count(),
+            chrono::duration<double, milli>(end - mid).count()};
+}
+
+bool write_ppm(const string& path)
+{
+    int width = 0;
+    int height = 0;
+    const ImU32* pixels = ImGui_ImplSoft_GetPixels(&width, &height);
+    FILE* out = fopen(path.c_str(), "wb");
+    if (!out) {
+        return false;
+    }
+    fprintf(out, "P6\n%d %d\n255\n", width, height);
+    vector<unsigned char> row(static_cast<size_t>(width) * 3);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            ImU32 c = pixels[static_cast<size_t>(y) * width + x];
+            row[3 * x + 0] = static_cast<unsigned char>(c >> IM_COL32_R_SHIFT);
+            row[3 * x + 1] = static_cast<unsigned char>(c >> IM_COL32_G_SHIFT);
+            row[3 * x + 2] = static_cast<unsigned char>(c >> IM_COL32_B_SHIFT);
+        }
+        fwrite(row.data(), 1, row.size(), out);
+    }
+    return fclose(out) == 0;
+}
+
+void write_stats(FILE* out, const char* name, vector<double> ms, bool last)
+{
+    sort(ms.begin(), ms.end());
+    auto at = [&](double q) { return ms[static_cast<size_t>(q * (ms.size() - 1) + 0.5)]; };
+    double sum = 0;
+    for (double m : ms) {
+        sum += m;
+    }
+    fprintf(out,
+            "  \"%s\": {\"mean\": %.6g, \"p50\": %.6g, \"p90\": %.6g, \"p99\": %.6g, "
+            "\"max\": %.6g}%s\n",
+            name, sum / ms.size(), at(0.5), at(0.9), at(0.99), ms.back(), last ? "" : ",");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options opts;
+    if (!parse_options(argc, argv, opts)) {
+        fprintf(stderr, USAGE, argv[0]);
+        return 2;
+    }
+
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr; // every run starts from the same layout
+    io.DisplaySize = ImVec2(static_cast<float>(opts.width), static_cast<float>(opts.height));
+    io.DeltaTime = 1.0f / 60;
+    io.MousePos = ImVec2(-FLT_MAX, -FLT_MAX);
+    // the models may log to cout, such as the loss of every RBF training step, stdout is for JSON
+    cout.rdbuf(cerr.rdbuf());
+    ImGui::LoadIniSettingsFromMemory(window_layout(opts.width, opts.height).c_str());
+    ImGui::StyleColorsDark();
+    ImGui_ImplSoft_Init(opts.threads);
+
+    string error;
+    string point_file = opts.point_file;
+    if (opts.points > 0) {
+        point_file = generate_points(opts.points, opts.seed, io.DisplaySize.x, io.DisplaySize.y,
+                                     error);
+    }
+    bool opened = error.empty() && (point_file.empty() || OpenPointFile(point_file, error));
+    if (opts.points > 0 && !point_file.empty()) {
+        // the GUI keeps a copy of the points
+        error_code ignored;
+        filesystem::remove(point_file, ignored);
+    }
+    if (!opened) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    // the first frames dispatch the fits, whose curves the timed frames then draw
+    draw_frame();
+    while (GuiJobs().busy) {
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    draw_frame();
+
+    vector<double> draw_ms;
+    vector<double> raster_ms;
+    for (int i = 0; i < opts.frames; i++) {
+        auto [draw, raster] = draw_frame();
+        draw_ms.push_back(draw);
+        raster_ms.push_back(raster);
+    }
+
+    if (!opts.image.empty() && !write_ppm(opts.image)) {
+        fprintf(stderr, "%s: cannot write %s\n", argv[0], opts.image.c_str());
+        return 1;
+    }
+
+    FILE* out = stdout;
+    if (!opts.output.empty()) {
+        out = fopen(opts.output.c_str(), "w");
+        if (!out) {
+            fprintf(stderr, "%s: cannot open %s\n", argv[0], opts.output.c_str());
+            return 1;
+        }
+    }
+    const ImDrawData* draw_data = ImGui::GetDrawData();
+    fprintf(out, "{\n  \"benchmark\": \"headless_frames\",\n");
+    fprintf(out, "  \"width\": %d,\n  \"height\": %d,\n  \"threads\": %d,\n", opts.width,
+            opts.height, opts.threads);
+    fprintf(out, "  \"frames\": %d,\n  \"vertices\": %d,\n  \"indices\": %d,\n", opts.frames,
+            draw_data->TotalVtxCount, draw_data->TotalIdxCount);
+    write_stats(out, "draw_ms", draw_ms, false);
+    write_stats(out, "raster_ms", raster_ms, true);
+    fprintf(out, "}\n");
+    if (out != stdout)
+        fclose(out);
+
+    ImGui_ImplSoft_Shutdown();
+    ImGui::DestroyContext();
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/// Controls sample_adaptive
+struct AdaptiveOptions
+{
+    float tolerance{0.25f};   // the largest distance of the curve from the polyline
+    int initial_segments{16}; // uniform segments every curve starts from, so that features
+                              // narrower than the whole range are not stepped over
+    int max_depth{10};        // the most times an initial segment is halved
+};
+
+/// Samples y = f(x) over [x_start, x_end] into the polyline out, for any Point type with float x
+/// and y members. Each segment is halved until the curve at its middle lies within tolerance of
+/// the chord, so flat stretches end up with few points and steep ones with many. Returns the
+/// number of evaluations of f. Segments whose check is not finite are kept as they are.
+template <typename P, typename F>
+int sample_adaptive(F&& f, float x_start, float x_end, const AdaptiveOptions& opts,
+                    std::vector<P>& out)
+{
+    // distance of m from the line through a and b
+    auto deviation = [](const P& a, const P& m, const P& b) {
+        float dx = b.x - a.x;
+        float dy = b.y - a.y;
+        float len = std::hypot(dx, dy);
+        if (len == 0)
+            return std::hypot(m.x - a.x, m.y - a.y);
+        return std::abs(dx * (m.y - a.y) - dy * (m.x - a.x)) / len;
+    };
+
+    struct Segment
+    {
+        P end;     // the start of a segment is the last point of out
+        int depth; // how many times it has been halved
+    };
+
+    out.clear();
+    const int n = std::max(1, opts.initial_segments);
+    const float step = (x_end - x_start) / n;
+
+    out.push_back(P{x_start, static_cast<float>(f(x_start))});
+    int evaluations = 1;
+
+    // the right halves waiting for their left neighbour to be accepted, at most max_depth + 1
+    std::vector<Segment> pending;
+    pending.reserve(opts.max_depth + 1);
+    for (int i = 1; i <= n; i++) {
+        float x = i == n ? x_end : x_start + i * step;
+        pending.push_back({P{x, static_cast<float>(f(x))}, 0});
+        evaluations++;
+
+        while (!pending.empty()) {
+            Segment& s = pending.back();
+            const P& a = out.back();
+            float mid_x = (a.x + s.end.x) * 0.5f;
+            P mid{mid_x, static_cast<float>(f(mid_x))};
+            evaluations++;
+
+            if (s.depth < opts.max_depth && deviation(a, mid, s.end) > opts.tolerance) {
+                int depth = ++s.depth;
+                pending.push_back({mid, depth});
+            }
+            else {
+                out.push_back(s.end);
+                pending.pop_back();
+            }
+        }
+    }
+    return evaluations;
+}
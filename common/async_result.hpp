@@ -0,0 +1,122 @@
+#pragma once
+
+#include "thread_pool.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/// Polled by long running work, true once the work has been superseded and should stop
+using Cancelled = std::function<bool()>;
+
+/// A result computed in the background and published by swapping buffers. Each submit() bumps the
+/// version, which cancels every older job, and jobs of one AsyncResult run one at a time, each
+/// starting from a copy of the last published result. get() never blocks and returns the last
+/// complete result until a newer one is published.
+template <typename T>
+class AsyncResult
+{
+public:
+    AsyncResult()
+        : state{std::make_shared<State>()}
+    {
+    }
+
+    /// Queues job(T& back, const Cancelled& cancelled) -> bool on the pool. back is published if
+    /// the job returns true and has not been cancelled by then. A job that throws publishes its
+    /// message as error() instead, and get() keeps the last complete result.
+    template <typename Job>
+    uint64_t submit(ThreadPool& pool, Job job)
+    {
+        auto version = ++state->version;
+        state->pending++;
+        pool.submit([state = state, version, job = std::move(job)]() mutable {
+            // the job is done once this returns, however it ends
+            struct Done
+            {
+                State& state;
+                ~Done()
+                {
+                    state.pending--;
+                }
+            } done{*state};
+
+            Cancelled cancelled = [&state, version] { return state->version.load() != version; };
+            // older jobs queued up behind a running one are dropped without ever starting
+            if (cancelled()) {
+                return;
+            }
+            std::lock_guard<std::mutex> lock{state->running};
+            if (cancelled()) {
+                return;
+            }
+            try {
+                T back = *std::atomic_load(&state->front);
+                if (job(back, cancelled) && !cancelled()) {
+                    auto front = std::make_shared<const T>(std::move(back));
+                    std::atomic_store(&state->front, std::move(front));
+                    state->set_error({});
+                    state->published = version;
+                }
+            }
+            catch (const std::exception& e) {
+                state->set_error(e.what());
+                state->published = version;
+            }
+            catch (...) {
+                state->set_error("unknown error");
+                state->published = version;
+            }
+        });
+        return version;
+    }
+
+    std::shared_ptr<const T> get() const
+    {
+        return std::atomic_load(&state->front);
+    }
+
+    /// The version returned by submit() for the job that produced get() or error(), 0 before the
+    /// first one. A failed job counts as published, so that it is not retried over and over.
+    uint64_t published() const
+    {
+        return state->published.load();
+    }
+
+    /// the message of the exception the last published job threw, empty if it succeeded
+    std::string error() const
+    {
+        std::lock_guard<std::mutex> lock{state->error_mutex};
+        return state->error;
+    }
+
+    /// true while a submitted job has not finished or been dropped yet
+    bool busy() const
+    {
+        return state->pending.load() > 0;
+    }
+
+private:
+    struct State
+    {
+        std::atomic<uint64_t> version{0};
+        std::atomic<uint64_t> published{0};
+        std::atomic<int> pending{0};
+        std::mutex running;                                          // held by the running job
+        std::shared_ptr<const T> front{std::make_shared<const T>()}; // the published result
+        mutable std::mutex error_mutex;
+        std::string error; // of the last published job
+
+        void set_error(std::string message)
+        {
+            std::lock_guard<std::mutex> lock{error_mutex};
+            error = std::move(message);
+        }
+    };
+    // shared with the queued jobs, which may outlive this object
+    std::shared_ptr<State> state;
+};
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "point.hpp"
+
+#include <imgui.h>
+#include <imgui_internal.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+/// Reduces the polyline p with ascending x to at most four points per pixel column of x + x0: the
+/// first, the lowest, the highest and the last point of the column, in their original order. The
+/// stroke then covers the same pixels as the full polyline. Points that are not finite are dropped.
+template <typename P>
+void decimate_columns(const std::vector<P>& p, float x0, std::vector<P>& out)
+{
+    out.clear();
+    size_t i = 0;
+    while (i < p.size()) {
+        if (!std::isfinite(p[i].x) || !std::isfinite(p[i].y)) {
+            i++;
+            continue;
+        }
+        const float column = std::floor(p[i].x + x0);
+        size_t first = i;
+        size_t last = i;
+        size_t lo = i;
+        size_t hi = i;
+        for (i++; i < p.size() && std::floor(p[i].x + x0) == column; i++) {
+            if (!std::isfinite(p[i].y))
+                continue;
+            last = i;
+            if (p[i].y < p[lo].y)
+                lo = i;
+            if (p[i].y > p[hi].y)
+                hi = i;
+        }
+
+        size_t kept[4] = {first, std::min(lo, hi), std::max(lo, hi), last};
+        out.push_back(p[kept[0]]);
+        for (int k = 1; k < 4; k++) {
+            if (kept[k] != kept[k - 1])
+                out.push_back(p[kept[k]]);
+        }
+    }
+}
+
+/// What CurveRenderer emitted since the last reset_stats()
+struct CurveDrawStats
+{
+    int curves{0};
+    int input_points{0}; // before decimation
+    int drawn_points{0}; // after decimation
+    int vertices{0};
+    int indices{0};
+    double build_ms{0}; // decimation and vertex generation
+};
+
+/// Draws predicted curves as polylines decimated to the pixel columns of the canvas. Each curve
+/// takes one reservation in the draw list. Anti-aliased lines of whole pixel widths, the kind a
+/// GUI with a baked font atlas draws, get their vertices from separate passes over plain float
+/// arrays, which compilers vectorize, instead of the per-point loop of ImDrawList::AddPolyline.
+/// Any other line is handed to AddPolyline. The scratch arrays are kept between curves.
+class CurveRenderer
+{
+public:
+    /// Draws the canvas points xy, offset by origin to screen space
+    void draw(ImDrawList* draw_list, const ImVec2& origin, const std::vector<Point>& xy,
+              ImU32 color, float thickness = 2.0f)
+    {
+        auto beg = std::chrono::steady_clock::now();
+        int vtx_begin = draw_list->VtxBuffer.Size;
+        int idx_begin = draw_list->IdxBuffer.Size;
+
+        decimate_columns(xy, origin.x, decimated);
+        const int n = static_cast<int>(decimated.size());
+        // 16-bit indices address 64k vertices per draw command, longer curves take a few chunks
+        for (int i = 0; i + 1 < n; i += MAX_CHUNK - 1) {
+            int count = std::min(MAX_CHUNK, n - i);
+            stroke(draw_list, origin, &decimated[i], count, color, thickness);
+        }
+
+        stats.curves++;
+        stats.input_points += static_cast<int>(xy.size());
+        stats.drawn_points += n;
+        stats.vertices += draw_list->VtxBuffer.Size - vtx_begin;
+        stats.indices += draw_list->IdxBuffer.Size - idx_begin;
+        auto elapsed = std::chrono::steady_clock::now() - beg;
+        stats.build_ms += std::chrono::duration<double, std::milli>(elapsed).count();
+    }
+
+    const CurveDrawStats& draw_stats() const
+    {
+        return stats;
+    }
+
+    void reset_stats()
+    {
+        stats = {};
+    }
+
+private:
+    static constexpr int MAX_CHUNK = 16384; // points per reservation
+
+    void stroke(ImDrawList* draw_list, const ImVec2& origin, const Point* p, int n, ImU32 color,
+                float thickness)
+    {
+        const ImDrawListFlags textured =
+            ImDrawListFlags_AntiAliasedLines | ImDrawListFlags_AntiAliasedLinesUseTex;
+        const bool use_texture = (draw_list->Flags & textured) == textured && thickness >= 1.0f &&
+                                 thickness == std::floor(thickness) &&
+                                 thickness < IM_DRAWLIST_TEX_LINES_WIDTH_MAX;
+        if (!use_texture) {
+            screen.resize(n);
+            for (int i = 0; i < n; i++) {
+                screen[i] = {origin.x + p[i].x, origin.y + p[i].y};
+            }
+            draw_list->AddPolyline(screen.data(), n, color, false, thickness);
+            return;
+        }
+
+        xs.resize(n);
+        ys.resize(n);
+        for (int i = 0; i < n; i++) {
+            xs[i] = origin.x + p[i].x;
+            ys[i] = origin.y + p[i].y;
+        }
+
+        // the normals of the segments, with the first and the last repeated for the end points
+        nx.resize(n + 1);
+        ny.resize(n + 1);
+        for (int i = 0; i < n - 1; i++) {
+            float dx = xs[i + 1] - xs[i];
+            float dy = ys[i + 1] - ys[i];
+            float d2 = dx * dx + dy * dy;
+            float inv = d2 > 0 ? 1 / std::sqrt(d2) : 0;
+            nx[i + 1] = dy * inv;
+            ny[i + 1] = -dx * inv;
+        }
+        nx[0] = nx[1];
+        ny[0] = ny[1];
+        nx[n] = nx[n - 1];
+        ny[n] = ny[n - 1];
+
+        // the offset of the edges at every point, the mean normal of its segments stretched as
+        // ImDrawList::AddPolyline does so that the stroke keeps its width at the joints
+        const float half_draw_size = thickness * 0.5f + 1;
+        ox.resize(n);
+        oy.resize(n);
+        for (int i = 0; i < n; i++) {
+            float mx = (nx[i] + nx[i + 1]) * 0.5f;
+            float my = (ny[i] + ny[i + 1]) * 0.5f;
+            float d2 = mx * mx + my * my;
+            float scale = d2 > 0.000001f ? std::min(1 / d2, 100.0f) : 1.0f;
+            ox[i] = mx * scale * half_draw_size;
+            oy[i] = my * scale * half_draw_size;
+        }
+
+        const ImVec4 uvs = draw_list->_Data->TexUvLines[static_cast<int>(thickness)];
+        const ImVec2 uv0{uvs.x, uvs.y};
+        const ImVec2 uv1{uvs.z, uvs.w};
+
+        draw_list->PrimReserve((n - 1) * 6, n * 2);
+        ImDrawVert* vtx = draw_list->_VtxWritePtr;
+        for (int i = 0; i < n; i++) {
+            vtx[2 * i + 0] = {{xs[i] + ox[i], ys[i] + oy[i]}, uv0, color};
+            vtx[2 * i + 1] = {{xs[i] - ox[i], ys[i] - oy[i]}, uv1, color};
+        }
+        ImDrawIdx* idx = draw_list->_IdxWritePtr;
+        const unsigned int base = draw_list->_VtxCurrentIdx;
+        for (int i = 0; i < n - 1; i++) {
+            auto a = static_cast<ImDrawIdx>(base + 2 * i);
+            auto b = static_cast<ImDrawIdx>(base + 2 * i + 2);
+            ImDrawIdx* tri = idx + 6 * i;
+            tri[0] = b;
+            tri[1] = a;
+            tri[2] = static_cast<ImDrawIdx>(a + 1);
+            tri[3] = static_cast<ImDrawIdx>(b + 1);
+            tri[4] = static_cast<ImDrawIdx>(a + 1);
+            tri[5] = b;
+        }
+        draw_list->_VtxWritePtr += 2 * n;
+        draw_list->_IdxWritePtr += 6 * (n - 1);
+        draw_list->_VtxCurrentIdx += 2 * n;
+    }
+
+    CurveDrawStats stats;
+    std::vector<Point> decimated;
+    std::vector<ImVec2> screen;
+    std::vector<float> xs;
+    std::vector<float> ys;
+    std::vector<float> nx; // the normals of the segments
+    std::vector<float> ny;
+    std::vector<float> ox; // the offsets of the edges from the points
+    std::vector<float> oy;
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "point.hpp"
+#include "point_set.hpp"
+
+#include <cmath>
+#include <vector>
+
+/// Shifts and scales both coordinates to zero mean and unit standard deviation
+struct Normalizer
+{
+    float mean_x;
+    float mean_y;
+    float std_x;
+    float std_y;
+    Normalizer() {}
+
+    Normalizer(const std::vector<Point>& points)
+        : mean_x{0}
+        , mean_y{0}
+        , std_x{0}
+        , std_y{0}
+    {
+        for (const auto& p : points) {
+            mean_x += p.x;
+            mean_y += p.y;
+        }
+        mean_x /= points.size();
+        mean_y /= points.size();
+
+        for (const auto& p : points) {
+            std_x += (p.x - mean_x) * (p.x - mean_x);
+            std_y += (p.y - mean_y) * (p.y - mean_y);
+        }
+        std_x /= points.size() - 1;
+        std_y /= points.size() - 1;
+        std_x = std::sqrt(std_x);
+        std_y = std::sqrt(std_y);
+    }
+
+    /// O(1), from the statistics kept by the set
+    Normalizer(const PointSet& points)
+        : mean_x{static_cast<float>(points.mean_x())}
+        , mean_y{static_cast<float>(points.mean_y())}
+        , std_x{static_cast<float>(std::sqrt(points.var_x()))}
+        , std_y{static_cast<float>(std::sqrt(points.var_y()))}
+    {
+    }
+
+    float normalize_x(float x) const
+    {
+        return (x - mean_x) / std_x;
+    }
+
+    float normalize_y(float y) const
+    {
+        return (y - mean_y) / std_y;
+    }
+
+    float denormalize_x(float x) const
+    {
+        return x * std_x + mean_x;
+    }
+
+    float denormalize_y(float y) const
+    {
+        return y * std_y + mean_y;
+    }
+};
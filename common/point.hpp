@@ -0,0 +1,7 @@
+#pragma once
+
+struct Point
+{
+    float x;
+    float y;
+};
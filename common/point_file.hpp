@@ -0,0 +1,340 @@
+#pragma once
+
+#include "normalizer.hpp"
+#include "point.hpp"
+
+#include "Eigen/Core"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/// The arrays of a point file start at multiples of this many bytes
+constexpr uint64_t POINT_FILE_ALIGN = 64;
+constexpr uint32_t POINT_FILE_VERSION = 1;
+constexpr char POINT_FILE_MAGIC[8] = {'G', '1', '0', '2', 'P', 'T', 'S', '\0'};
+
+/// The start of a binary point file. It is followed by the x array, the y array and optionally the
+/// indices of the points in ascending x, each at its offset from the start of the file. All
+/// values are little endian.
+struct PointFileHeader
+{
+    char magic[8];         // POINT_FILE_MAGIC
+    uint32_t version;      // POINT_FILE_VERSION
+    uint32_t scalar_size;  // 4 for float32 or 8 for float64 coordinates
+    uint64_t count;        // number of points
+    uint64_t x_offset;     // of count coordinates
+    uint64_t y_offset;     // of count coordinates
+    uint64_t order_offset; // of count uint32 indices, 0 if there are none
+    double mean_x;         // the statistics Normalizer needs, with the sample standard deviation
+    double mean_y;
+    double std_x;
+    double std_y;
+};
+static_assert(sizeof(PointFileHeader) == 80, "the header is written as is");
+
+/// Writes points to path with Scalar (float or double) coordinates and precomputed statistics.
+/// With sorted the x-sorted permutation is stored as well. Returns false and sets error on
+/// failure.
+template <typename Scalar>
+bool write_point_file(const std::string& path, const std::vector<Point>& points, bool sorted,
+                      std::string& error)
+{
+    static_assert(std::is_same_v<Scalar, float> || std::is_same_v<Scalar, double>,
+                  "coordinates are float32 or float64");
+
+    if (points.size() > UINT32_MAX) {
+        error = "more points than a uint32 index can address";
+        return false;
+    }
+    const uint64_t n = points.size();
+    auto align = [](uint64_t offset) {
+        return (offset + POINT_FILE_ALIGN - 1) / POINT_FILE_ALIGN * POINT_FILE_ALIGN;
+    };
+
+    PointFileHeader header{};
+    std::memcpy(header.magic, POINT_FILE_MAGIC, sizeof(header.magic));
+    header.version = POINT_FILE_VERSION;
+    header.scalar_size = sizeof(Scalar);
+    header.count = n;
+    header.x_offset = align(sizeof(PointFileHeader));
+    header.y_offset = align(header.x_offset + n * sizeof(Scalar));
+    header.order_offset = sorted ? align(header.y_offset + n * sizeof(Scalar)) : 0;
+
+    // Welford's update, in double whatever the coordinates are stored in
+    double m2_x = 0;
+    double m2_y = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        double dx = points[i].x - header.mean_x;
+        double dy = points[i].y - header.mean_y;
+        header.mean_x += dx / (i + 1);
+        header.mean_y += dy / (i + 1);
+        m2_x += dx * (points[i].x - header.mean_x);
+        m2_y += dy * (points[i].y - header.mean_y);
+    }
+    header.std_x = n > 1 ? std::sqrt(m2_x / (n - 1)) : 0;
+    header.std_y = n > 1 ? std::sqrt(m2_y / (n - 1)) : 0;
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        error = "cannot open " + path + " for writing";
+        return false;
+    }
+
+    auto pad_to = [&](uint64_t offset) {
+        static const char zeros[POINT_FILE_ALIGN] = {};
+        out.write(zeros, offset - static_cast<uint64_t>(out.tellp()));
+    };
+    auto write_column = [&](uint64_t offset, float Point::*member) {
+        pad_to(offset);
+        std::vector<Scalar> column(n);
+        for (uint64_t i = 0; i < n; i++) {
+            column[i] = points[i].*member;
+        }
+        out.write(reinterpret_cast<const char*>(column.data()), n * sizeof(Scalar));
+    };
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    write_column(header.x_offset, &Point::x);
+    write_column(header.y_offset, &Point::y);
+    if (sorted) {
+        std::vector<uint32_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(),
+                         [&](uint32_t a, uint32_t b) { return points[a].x < points[b].x; });
+        pad_to(header.order_offset);
+        out.write(reinterpret_cast<const char*>(order.data()), n * sizeof(uint32_t));
+    }
+
+    if (!out) {
+        error = "cannot write " + path;
+        return false;
+    }
+    return true;
+}
+
+/// A binary point file mapped into memory. The coordinates are read in place through Eigen::Map
+/// views, so opening costs the same for any number of points and nothing is parsed or copied.
+/// The mapping is released by close() or on destruction, which invalidates every view.
+class MappedPointFile
+{
+public:
+    template <typename Scalar>
+    using Map = Eigen::Map<const Eigen::Matrix<Scalar, Eigen::Dynamic, 1>, Eigen::Aligned16>;
+
+    MappedPointFile() {}
+    MappedPointFile(const MappedPointFile&) = delete;
+    MappedPointFile& operator=(const MappedPointFile&) = delete;
+
+    ~MappedPointFile()
+    {
+        close();
+    }
+
+    /// Maps path and checks its header and that every array lies within the file, not the values
+    /// in them. Returns false and sets error on failure.
+    bool open(const std::string& path, std::string& error)
+    {
+        close();
+        if (!map(path, error)) {
+            return false;
+        }
+
+        if (length < sizeof(PointFileHeader)) {
+            error = path + " is too short for a point file";
+            close();
+            return false;
+        }
+        std::memcpy(&head, base, sizeof(head));
+
+        auto fits = [&](uint64_t offset, uint64_t element_size) {
+            return offset % POINT_FILE_ALIGN == 0 && offset <= length &&
+                   head.count <= (length - offset) / element_size;
+        };
+        std::string problem;
+        if (std::memcmp(head.magic, POINT_FILE_MAGIC, sizeof(head.magic)) != 0) {
+            problem = " is not a point file";
+        }
+        else if (head.version != POINT_FILE_VERSION) {
+            problem = " has unsupported version " + std::to_string(head.version);
+        }
+        else if (head.scalar_size != sizeof(float) && head.scalar_size != sizeof(double)) {
+            problem = " has coordinates of " + std::to_string(head.scalar_size) + " bytes";
+        }
+        else if (!fits(head.x_offset, head.scalar_size) || !fits(head.y_offset, head.scalar_size) ||
+                 (head.order_offset != 0 && !fits(head.order_offset, sizeof(uint32_t)))) {
+            problem = " is truncated or has misaligned arrays";
+        }
+        if (!problem.empty()) {
+            error = path + problem;
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close()
+    {
+        if (!base) {
+            return;
+        }
+#if defined(_WIN32)
+        UnmapViewOfFile(base);
+#else
+        munmap(const_cast<char*>(base), length);
+#endif
+        base = nullptr;
+        length = 0;
+        head = {};
+    }
+
+    bool is_open() const
+    {
+        return base != nullptr;
+    }
+
+    size_t size() const
+    {
+        return static_cast<size_t>(head.count);
+    }
+
+    /// true for float64 coordinates, false for float32
+    bool is_double() const
+    {
+        return head.scalar_size == sizeof(double);
+    }
+
+    const PointFileHeader& header() const
+    {
+        return head;
+    }
+
+    /// the normalizer of the points, from the statistics stored in the header
+    Normalizer normalizer() const
+    {
+        Normalizer norm;
+        norm.mean_x = static_cast<float>(head.mean_x);
+        norm.mean_y = static_cast<float>(head.mean_y);
+        norm.std_x = static_cast<float>(head.std_x);
+        norm.std_y = static_cast<float>(head.std_y);
+        return norm;
+    }
+
+    /// The coordinates in place, Scalar has to match is_double()
+    template <typename Scalar>
+    Map<Scalar> xs() const
+    {
+        return column<Scalar>(head.x_offset);
+    }
+
+    template <typename Scalar>
+    Map<Scalar> ys() const
+    {
+        return column<Scalar>(head.y_offset);
+    }
+
+    /// The indices of the points in ascending x, nullptr if the file has none. open() does not
+    /// read them, so they are not checked against size().
+    const uint32_t* order() const
+    {
+        return head.order_offset ? reinterpret_cast<const uint32_t*>(base + head.order_offset)
+                                 : nullptr;
+    }
+
+    /// Interleaves the coordinates into out, for the solvers that take a vector of points
+    void copy_to(std::vector<Point>& out) const
+    {
+        out.resize(size());
+        if (is_double()) {
+            copy_columns<double>(out);
+        }
+        else {
+            copy_columns<float>(out);
+        }
+    }
+
+private:
+    template <typename Scalar>
+    Map<Scalar> column(uint64_t offset) const
+    {
+        auto data = reinterpret_cast<const Scalar*>(base + offset);
+        return Map<Scalar>{data, static_cast<Eigen::Index>(head.count)};
+    }
+
+    template <typename Scalar>
+    void copy_columns(std::vector<Point>& out) const
+    {
+        auto x = xs<Scalar>();
+        auto y = ys<Scalar>();
+        for (size_t i = 0; i < out.size(); i++) {
+            out[i] = {static_cast<float>(x(i)), static_cast<float>(y(i))};
+        }
+    }
+
+    bool map(const std::string& path, std::string& error)
+    {
+#if defined(_WIN32)
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            error = "cannot open " + path;
+            return false;
+        }
+        LARGE_INTEGER file_size;
+        GetFileSizeEx(file, &file_size);
+        length = static_cast<uint64_t>(file_size.QuadPart);
+        HANDLE mapping =
+            length ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+        CloseHandle(file);
+        if (!mapping) {
+            error = "cannot map " + path;
+            return false;
+        }
+        base = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        CloseHandle(mapping);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            error = "cannot open " + path;
+            return false;
+        }
+        struct stat st;
+        fstat(fd, &st);
+        length = static_cast<uint64_t>(st.st_size);
+        void* addr = length ? mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+        ::close(fd);
+        base = addr == MAP_FAILED ? nullptr : static_cast<const char*>(addr);
+#endif
+        if (!base) {
+            error = "cannot map " + path;
+            length = 0;
+            return false;
+        }
+        return true;
+    }
+
+    const char* base{nullptr}; // the start of the mapping
+    uint64_t length{0};        // of the file
+    PointFileHeader head{};
+};
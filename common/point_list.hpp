@@ -0,0 +1,127 @@
+#pragma once
+
+#include "point.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/// Editable points, each with an id that stays the same while other points are added or removed,
+/// so that a selection survives edits. Removal moves the last point into the gap instead of
+/// shifting the tail, which makes every edit O(1) but does not keep the order of the points. The
+/// id table keeps a tombstone for every removed id until clear() or assign(). The points are copied
+/// on write, so a snapshot of them for a background job is free until the next edit.
+class PointList
+{
+public:
+    static constexpr size_t NONE = static_cast<size_t>(-1); // the index of a removed id
+    static constexpr uint32_t NO_ID = UINT32_MAX;           // an id no point ever has
+
+    const std::vector<Point>& points() const
+    {
+        return *list;
+    }
+
+    /// The points, shared until the next edit, which copies them if the snapshot is still held
+    std::shared_ptr<const std::vector<Point>> snapshot() const
+    {
+        return list;
+    }
+
+    size_t size() const
+    {
+        return list->size();
+    }
+
+    bool empty() const
+    {
+        return list->empty();
+    }
+
+    const Point& operator[](size_t i) const
+    {
+        return (*list)[i];
+    }
+
+    std::vector<Point>::const_iterator begin() const
+    {
+        return list->begin();
+    }
+
+    std::vector<Point>::const_iterator end() const
+    {
+        return list->end();
+    }
+
+    /// the id of the point at index i
+    uint32_t id(size_t i) const
+    {
+        return ids[i];
+    }
+
+    /// the index of the point with id, NONE if it has been removed
+    size_t index(uint32_t id) const
+    {
+        return id < indices.size() ? indices[id] : NONE;
+    }
+
+    /// Appends p and returns its id
+    uint32_t add(const Point& p)
+    {
+        auto id = static_cast<uint32_t>(indices.size());
+        indices.push_back(list->size());
+        ids.push_back(id);
+        edit().push_back(p);
+        return id;
+    }
+
+    /// Removes the point at index i, the last point takes its place
+    void remove(size_t i)
+    {
+        auto& points = edit();
+        indices[ids[i]] = NONE;
+        if (i + 1 != points.size()) {
+            points[i] = points.back();
+            ids[i] = ids.back();
+            indices[ids[i]] = i;
+        }
+        points.pop_back();
+        ids.pop_back();
+    }
+
+    void clear()
+    {
+        list = std::make_shared<std::vector<Point>>();
+        ids.clear();
+        indices.clear();
+    }
+
+    /// Replaces the points, which get the ids 0 to n - 1
+    void assign(std::vector<Point> points)
+    {
+        list = std::make_shared<std::vector<Point>>(std::move(points));
+        ids.resize(list->size());
+        indices.resize(list->size());
+        for (size_t i = 0; i < list->size(); i++) {
+            ids[i] = static_cast<uint32_t>(i);
+            indices[i] = i;
+        }
+    }
+
+private:
+    /// The points to modify, copied first if a snapshot still shares them. Only this thread hands
+    /// out snapshots, so a count of 1 cannot grow behind its back.
+    std::vector<Point>& edit()
+    {
+        if (list.use_count() > 1) {
+            list = std::make_shared<std::vector<Point>>(*list);
+        }
+        return *list;
+    }
+
+    std::shared_ptr<std::vector<Point>> list{std::make_shared<std::vector<Point>>()};
+    std::vector<uint32_t> ids;   // ids[i] is the id of list[i]
+    std::vector<size_t> indices; // indices[id] is the index of id in list, NONE once removed
+};
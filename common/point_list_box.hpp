@@ -0,0 +1,36 @@
+#pragma once
+
+#include "point_list.hpp"
+
+#include <imgui.h>
+
+#include <cstdio>
+
+/// A list box of the points that formats only the visible rows, one at a time into a buffer on the
+/// stack, so drawing it costs the same for any number of points. A click selects the id of the
+/// row. Returns true if the selection changed.
+inline bool PointListBox(const char* label, const PointList& points, uint32_t& selected,
+                         int height_in_items = 30)
+{
+    const int count = static_cast<int>(points.size());
+    if (!ImGui::ListBoxHeader(label, count, height_in_items)) {
+        return false;
+    }
+
+    bool changed = false;
+    char row[64];
+    ImGuiListClipper clipper;
+    clipper.Begin(count);
+    while (clipper.Step()) {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+            const uint32_t id = points.id(i);
+            std::snprintf(row, sizeof(row), "#%u  x: %g, y: %g", id, points[i].x, points[i].y);
+            if (ImGui::Selectable(row, id == selected)) {
+                selected = id;
+                changed = true;
+            }
+        }
+    }
+    ImGui::ListBoxFooter();
+    return changed;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "point.hpp"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <vector>
+
+/// Draws points[first, last) as markers of the given radius at origin + point, squares where they
+/// are too dense to tell apart. The range is clamped to the points.
+inline void draw_point_markers(ImDrawList* draw_list, const ImVec2& origin,
+                               const std::vector<Point>& points, size_t first, size_t last,
+                               float radius, ImU32 color)
+{
+    static_assert(sizeof(Point) == sizeof(ImVec2), "points are drawn in place as ImVec2");
+    last = std::min(last, points.size());
+    if (first >= last) {
+        return;
+    }
+    draw_list->AddMarkers(reinterpret_cast<const ImVec2*>(points.data() + first),
+                          static_cast<int>(last - first), origin, radius, color,
+                          ImDrawMarkerFlags_SquareWhenDense);
+}
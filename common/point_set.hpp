@@ -0,0 +1,233 @@
+#pragma once
+
+#include "Eigen/Core"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <set>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/// A set of 2D points stored as separate aligned x and y arrays. Mean and variance of both
+/// coordinates are kept up to date by Welford's update on every edit, and so are an x-sorted
+/// index and the pair of points closest in x, so each edit costs O(log n) and none of them needs a
+/// scan. Erasing moves the last point into the hole, the order of the points is not kept.
+class PointSet
+{
+public:
+    using Array = std::vector<float, Eigen::aligned_allocator<float>>;
+    using Map = Eigen::Map<const Eigen::VectorXf, Eigen::Aligned16>;
+
+    PointSet() {}
+
+    template <typename It>
+    PointSet(It first, It last)
+    {
+        for (; first != last; ++first) {
+            push_back(first->x, first->y);
+        }
+    }
+
+    size_t size() const
+    {
+        return xs.size();
+    }
+
+    bool empty() const
+    {
+        return xs.empty();
+    }
+
+    float x(size_t i) const
+    {
+        return xs[i];
+    }
+
+    float y(size_t i) const
+    {
+        return ys[i];
+    }
+
+    /// the arrays as Eigen vectors, without a copy
+    Map x_map() const
+    {
+        return Map{xs.data(), static_cast<Eigen::Index>(xs.size())};
+    }
+
+    Map y_map() const
+    {
+        return Map{ys.data(), static_cast<Eigen::Index>(ys.size())};
+    }
+
+    void push_back(float x, float y)
+    {
+        auto i = static_cast<uint32_t>(xs.size());
+        xs.push_back(x);
+        ys.push_back(y);
+        add_stats(x, y);
+        insert_sorted(i);
+    }
+
+    /// removes point i and moves the last point to index i, nothing if there is no point i
+    void erase(size_t i)
+    {
+        if (i >= xs.size()) {
+            return;
+        }
+        auto last = static_cast<uint32_t>(xs.size() - 1);
+        remove_stats(xs[i], ys[i]);
+        remove_sorted(static_cast<uint32_t>(i));
+        if (i != last) {
+            remove_sorted(last);
+            xs[i] = xs[last];
+            ys[i] = ys[last];
+            insert_sorted(static_cast<uint32_t>(i));
+        }
+        xs.pop_back();
+        ys.pop_back();
+    }
+
+    void clear()
+    {
+        xs.clear();
+        ys.clear();
+        by_x.clear();
+        gaps.clear();
+        stats = {};
+    }
+
+    double mean_x() const
+    {
+        return stats.mean_x;
+    }
+
+    double mean_y() const
+    {
+        return stats.mean_y;
+    }
+
+    /// the sample variance, with n - 1 in the denominator
+    double var_x() const
+    {
+        return stats.count > 1 ? stats.m2_x / (stats.count - 1) : 0;
+    }
+
+    double var_y() const
+    {
+        return stats.count > 1 ? stats.m2_y / (stats.count - 1) : 0;
+    }
+
+    /// the indices of the points in ascending x
+    std::vector<uint32_t> sorted_index() const
+    {
+        std::vector<uint32_t> ret;
+        ret.reserve(by_x.size());
+        for (const auto& e : by_x) {
+            ret.push_back(e.second);
+        }
+        return ret;
+    }
+
+    /// the two points with the smallest distance in x, the first one has the lower x. Needs at
+    /// least two points.
+    std::pair<uint32_t, uint32_t> closest_pair() const
+    {
+        const auto& g = *gaps.begin();
+        return {std::get<1>(g), std::get<2>(g)};
+    }
+
+    float min_gap() const
+    {
+        return gaps.empty() ? INFINITY : std::get<0>(*gaps.begin());
+    }
+
+private:
+    using Key = std::pair<float, uint32_t>;            // x and the index of the point
+    using Gap = std::tuple<float, uint32_t, uint32_t>; // x distance of sorted neighbours
+
+    void add_stats(double x, double y)
+    {
+        auto& s = stats;
+        s.count++;
+        double dx = x - s.mean_x;
+        double dy = y - s.mean_y;
+        s.mean_x += dx / s.count;
+        s.mean_y += dy / s.count;
+        s.m2_x += dx * (x - s.mean_x);
+        s.m2_y += dy * (y - s.mean_y);
+    }
+
+    /// Welford's update run backwards
+    void remove_stats(double x, double y)
+    {
+        auto& s = stats;
+        if (--s.count == 0) {
+            s = {};
+            return;
+        }
+        double dx = x - s.mean_x;
+        double dy = y - s.mean_y;
+        s.mean_x -= dx / s.count;
+        s.mean_y -= dy / s.count;
+        // the subtraction may leave a tiny negative value behind
+        s.m2_x = std::max(0.0, s.m2_x - dx * (x - s.mean_x));
+        s.m2_y = std::max(0.0, s.m2_y - dy * (y - s.mean_y));
+    }
+
+    Gap gap(const Key& a, const Key& b) const
+    {
+        return {b.first - a.first, a.second, b.second};
+    }
+
+    void insert_sorted(uint32_t i)
+    {
+        auto it = by_x.insert({xs[i], i}).first;
+        auto next = std::next(it);
+        bool has_prev = it != by_x.begin();
+        bool has_next = next != by_x.end();
+        if (has_prev && has_next) {
+            gaps.erase(gaps.find(gap(*std::prev(it), *next)));
+        }
+        if (has_prev) {
+            gaps.insert(gap(*std::prev(it), *it));
+        }
+        if (has_next) {
+            gaps.insert(gap(*it, *next));
+        }
+    }
+
+    void remove_sorted(uint32_t i)
+    {
+        auto it = by_x.find({xs[i], i});
+        auto next = std::next(it);
+        bool has_prev = it != by_x.begin();
+        bool has_next = next != by_x.end();
+        if (has_prev) {
+            gaps.erase(gaps.find(gap(*std::prev(it), *it)));
+        }
+        if (has_next) {
+            gaps.erase(gaps.find(gap(*it, *next)));
+        }
+        if (has_prev && has_next) {
+            gaps.insert(gap(*std::prev(it), *next));
+        }
+        by_x.erase(it);
+    }
+
+    Array xs;
+    Array ys;
+    std::set<Key> by_x;
+    std::set<Gap> gaps; // unique, the indices tell equal distances apart
+
+    struct
+    {
+        double count{0};
+        double mean_x{0};
+        double mean_y{0};
+        double m2_x{0}; // sum of squared deviations from mean_x
+        double m2_y{0};
+    } stats;
+};
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/// A timed phase of some thread
+struct ProfileEvent
+{
+    const char* name;  // a string literal, phases are told apart by its address
+    uint64_t begin;    // ns since the profiler started
+    uint64_t duration; // ns
+    uint32_t thread;   // a small index, in the order the threads first recorded
+};
+
+/// Collects the phases timed by ScopedTimer into a fixed ring of the latest events. Recording is
+/// lock-free for any number of threads: a writer claims a slot with one fetch_add and publishes it
+/// under a sequence number, so a reader skips the slots that are being overwritten instead of
+/// waiting for them. Disabled, which it is until enable(true), a timer costs one relaxed load.
+class Profiler
+{
+public:
+    static constexpr size_t CAPACITY = 1 << 14; // a power of two
+
+    void enable(bool on)
+    {
+        enabled.store(on, std::memory_order_relaxed);
+    }
+
+    bool is_enabled() const
+    {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    uint64_t now() const
+    {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    }
+
+    void record(const char* name, uint64_t begin, uint64_t duration)
+    {
+        uint64_t i = head.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = slots[i & (CAPACITY - 1)];
+        slot.seq.store(2 * i + 1, std::memory_order_relaxed); // odd while it is written
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.name.store(name, std::memory_order_relaxed);
+        slot.begin.store(begin, std::memory_order_relaxed);
+        slot.duration.store(duration, std::memory_order_relaxed);
+        slot.thread.store(thread_index(), std::memory_order_relaxed);
+        slot.seq.store(2 * i + 2, std::memory_order_release);
+    }
+
+    /// Appends the complete events still in the ring to out, oldest first
+    void snapshot(std::vector<ProfileEvent>& out) const
+    {
+        uint64_t end = head.load(std::memory_order_acquire);
+        uint64_t begin = end > CAPACITY ? end - CAPACITY : 0;
+        for (uint64_t i = begin; i < end; i++) {
+            const Slot& slot = slots[i & (CAPACITY - 1)];
+            uint64_t seq = slot.seq.load(std::memory_order_acquire);
+            if (seq != 2 * i + 2) {
+                continue; // still being written, or already overwritten by a newer event
+            }
+            ProfileEvent event{slot.name.load(std::memory_order_relaxed),
+                               slot.begin.load(std::memory_order_relaxed),
+                               slot.duration.load(std::memory_order_relaxed),
+                               slot.thread.load(std::memory_order_relaxed)};
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) == seq) {
+                out.push_back(event);
+            }
+        }
+    }
+
+    /// Writes the events in the ring as Chrome trace-event JSON, as read by chrome://tracing or
+    /// Perfetto. Returns false if path cannot be written.
+    bool write_chrome_trace(const std::string& path) const
+    {
+        std::vector<ProfileEvent> events;
+        snapshot(events);
+
+        FILE* out = std::fopen(path.c_str(), "w");
+        if (!out) {
+            return false;
+        }
+        std::fprintf(out, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+        for (size_t i = 0; i < events.size(); i++) {
+            const auto& e = events[i];
+            std::fprintf(out,
+                         "%s\n{\"name\": \"%s\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, "
+                         "\"pid\": 1, \"tid\": %u}",
+                         i ? "," : "", e.name, e.begin * 1e-3, e.duration * 1e-3, e.thread);
+        }
+        std::fprintf(out, "\n]}\n");
+        return std::fclose(out) == 0;
+    }
+
+private:
+    static uint32_t thread_index()
+    {
+        static std::atomic<uint32_t> next{0};
+        thread_local uint32_t index = next++;
+        return index;
+    }
+
+    struct Slot
+    {
+        std::atomic<uint64_t> seq{0}; // 2 i + 2 once event i is complete
+        std::atomic<const char*> name{nullptr};
+        std::atomic<uint64_t> begin{0};
+        std::atomic<uint64_t> duration{0};
+        std::atomic<uint32_t> thread{0};
+    };
+
+    std::atomic<bool> enabled{false};
+    std::atomic<uint64_t> head{0}; // the number of events ever recorded
+    std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+    std::vector<Slot> slots = std::vector<Slot>(CAPACITY);
+};
+
+/// the profiler every ScopedTimer records into
+inline Profiler& profiler()
+{
+    static Profiler instance;
+    return instance;
+}
+
+/// Records the time from its construction to stop() or its destruction as the phase name, which
+/// has to be a string literal. Does nothing if the profiler was disabled when it was constructed.
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(const char* name)
+        : name{profiler().is_enabled() ? name : nullptr}
+        , begin{this->name ? profiler().now() : 0}
+    {
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    ~ScopedTimer()
+    {
+        stop();
+    }
+
+    /// ends the phase before the end of the scope
+    void stop()
+    {
+        if (name) {
+            profiler().record(name, begin, profiler().now() - begin);
+            name = nullptr;
+        }
+    }
+
+private:
+    const char* name;
+    uint64_t begin;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+/// times the rest of the enclosing scope as the phase name
+#define PROFILE_SCOPE(name) ScopedTimer PROFILE_CONCAT(profile_scope_, __LINE__){name}
+
+/// Latency percentiles of one phase, in ms
+struct PhaseStats
+{
+    const char* name;
+    int count;
+    double p50;
+    double p90;
+    double p99;
+    double max;
+};
+
+/// The percentiles of each phase over the events that ended within window ns of the latest one,
+/// in the order the phases first appear
+inline std::vector<PhaseStats> phase_stats(const std::vector<ProfileEvent>& events,
+                                           uint64_t window)
+{
+    uint64_t latest = 0;
+    for (const auto& e : events) {
+        latest = std::max(latest, e.begin + e.duration);
+    }
+
+    std::vector<const char*> names;
+    std::vector<std::vector<double>> durations;
+    for (const auto& e : events) {
+        if (e.begin + e.duration + window < latest) {
+            continue;
+        }
+        auto it = std::find(names.begin(), names.end(), e.name);
+        if (it == names.end()) {
+            names.push_back(e.name);
+            durations.emplace_back();
+            it = names.end() - 1;
+        }
+        durations[it - names.begin()].push_back(e.duration * 1e-6);
+    }
+
+    std::vector<PhaseStats> stats;
+    for (size_t i = 0; i < names.size(); i++) {
+        auto& d = durations[i];
+        std::sort(d.begin(), d.end());
+        auto at = [&](double q) { return d[static_cast<size_t>(q * (d.size() - 1) + 0.5)]; };
+        stats.push_back(
+            {names[i], static_cast<int>(d.size()), at(0.5), at(0.9), at(0.99), d.back()});
+    }
+    return stats;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "profiler.hpp"
+#include "redraw_tracker.hpp"
+
+#include <imgui.h>
+
+#include <string>
+#include <vector>
+
+/// A window that switches the profiler on and off, shows the percentiles of every phase over the
+/// last two seconds and exports the recorded events as a Chrome trace. It also has the switch of
+/// the main loop between drawing on demand and drawing every frame.
+inline void DrawProfilerWindow()
+{
+    static char trace_path[260] = "trace.json";
+    static std::string status;
+    static std::vector<ProfileEvent> events;
+
+    ImGui::SetNextWindowCollapsed(true, ImGuiCond_FirstUseEver);
+    if (ImGui::Begin("Profiler")) {
+        bool enabled = profiler().is_enabled();
+        if (ImGui::Checkbox("Record", &enabled)) {
+            profiler().enable(enabled);
+        }
+        bool always = redraw_tracker().always_redraw();
+        if (ImGui::Checkbox("Always redraw", &always)) {
+            redraw_tracker().set_always_redraw(always);
+        }
+        ImGui::SameLine();
+        ImGui::Text("%llu frames drawn, %llu skipped",
+                    static_cast<unsigned long long>(redraw_tracker().drawn_frames()),
+                    static_cast<unsigned long long>(redraw_tracker().skipped_frames()));
+
+        ImGui::InputText("##trace", trace_path, sizeof(trace_path));
+        ImGui::SameLine();
+        if (ImGui::Button("Export trace")) {
+            status = profiler().write_chrome_trace(trace_path)
+                         ? std::string("wrote ") + trace_path
+                         : std::string("cannot write ") + trace_path;
+        }
+        if (!status.empty()) {
+            ImGui::TextUnformatted(status.c_str());
+        }
+
+        if (enabled) {
+            events.clear();
+            profiler().snapshot(events);
+            auto stats = phase_stats(events, 2000000000);
+
+            ImGui::Columns(6, "phases");
+            for (const char* header : {"phase", "count", "p50 ms", "p90 ms", "p99 ms", "max ms"}) {
+                ImGui::TextUnformatted(header);
+                ImGui::NextColumn();
+            }
+            ImGui::Separator();
+            for (const auto& s : stats) {
+                ImGui::TextUnformatted(s.name);
+                ImGui::NextColumn();
+                ImGui::Text("%d", s.count);
+                ImGui::NextColumn();
+                for (double ms : {s.p50, s.p90, s.p99, s.max}) {
+                    ImGui::Text("%.3f", ms);
+                    ImGui::NextColumn();
+                }
+            }
+            ImGui::Columns(1);
+        }
+    }
+    ImGui::End();
+}
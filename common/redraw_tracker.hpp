@@ -0,0 +1,110 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+/// What the background jobs of a GUI are doing
+struct JobState
+{
+    bool busy{false};      // some job has not finished yet
+    uint64_t published{0}; // grows whenever a job publishes a result
+};
+
+/// Decides which iterations of an on-demand main loop draw a frame. Input events, results that
+/// background jobs publish and requests for a frame at a later time, such as ImGui's cursor blink,
+/// make frames due; in between the loop blocks in the window system for timeout() seconds. Times
+/// are in seconds on a clock the caller passes in, so the decisions can be driven without a window.
+class RedrawTracker
+{
+public:
+    static constexpr int SETTLE_FRAMES = 3;      // after an event, ImGui shows some a frame late
+    static constexpr double JOB_POLL = 1.0 / 60; // s between checks for finished background jobs
+    static constexpr double IDLE_WAIT = 1.0;     // s, the longest block, in case an event is missed
+    static constexpr double NEVER = std::numeric_limits<double>::infinity();
+
+    /// draws every iteration, as the loop did before, to debug or to profile whole frames
+    void set_always_redraw(bool on)
+    {
+        always = on;
+    }
+
+    bool always_redraw() const
+    {
+        return always;
+    }
+
+    /// an input or window event arrived
+    void input()
+    {
+        settle = SETTLE_FRAMES;
+    }
+
+    /// the state of the background jobs, the frame after one publishes a result is drawn
+    void jobs(const JobState& state)
+    {
+        if (state.published != published) {
+            settle = std::max(settle, 1);
+        }
+        published = state.published;
+        jobs_busy = state.busy;
+    }
+
+    /// asks for a frame delay s after now at the latest, a drawn frame clears the request
+    void request(double now, double delay = 0)
+    {
+        deadline = std::min(deadline, now + delay);
+    }
+
+    /// Whether the iteration at now draws a frame
+    bool draw(double now)
+    {
+        if (!always && settle == 0 && deadline > now) {
+            skipped++;
+            return false;
+        }
+        settle = std::max(settle - 1, 0);
+        deadline = NEVER;
+        drawn++;
+        return true;
+    }
+
+    /// How long the loop may wait for events at now before it asks draw() again, 0 to only poll
+    double timeout(double now) const
+    {
+        if (always || settle > 0) {
+            return 0;
+        }
+        double wait = std::min(IDLE_WAIT, deadline - now);
+        if (jobs_busy) {
+            wait = std::min(wait, JOB_POLL);
+        }
+        return std::max(wait, 0.0);
+    }
+
+    uint64_t drawn_frames() const
+    {
+        return drawn;
+    }
+
+    uint64_t skipped_frames() const
+    {
+        return skipped;
+    }
+
+private:
+    bool always{false};
+    bool jobs_busy{false};
+    uint64_t published{0};     // by the jobs as of the last jobs()
+    int settle{SETTLE_FRAMES}; // frames still to draw after the last event, the first frames too
+    double deadline{NEVER};    // of the earliest request since the last frame
+    uint64_t drawn{0};
+    uint64_t skipped{0};
+};
+
+/// the tracker of the main loop, its debug toggle is in the profiler window
+inline RedrawTracker& redraw_tracker()
+{
+    static RedrawTracker instance;
+    return instance;
+}
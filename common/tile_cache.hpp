@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+/// Identifies a tile of a predicted curve
+struct TileKey
+{
+    uint64_t version; // of the model the tile was predicted from
+    int64_t index;    // the tile covers [index, index + 1) tile widths along x
+    int level;        // the zoom level, the sample spacing is 2^level
+
+    bool operator<(const TileKey& other) const
+    {
+        return std::tie(version, index, level) < std::tie(other.version, other.index, other.level);
+    }
+};
+
+/// A bounded map of tiles that evicts the least recently used one once it is full. The tiles are
+/// shared and never modified, so copying the cache does not copy them. Eviction scans for the
+/// oldest entry, which is cheap at the few hundred tiles a view needs.
+template <typename Tile>
+class TileCache
+{
+public:
+    explicit TileCache(size_t capacity = 256)
+        : capacity{capacity}
+    {
+    }
+
+    /// the tile, or nullptr if it is not cached
+    std::shared_ptr<const Tile> find(const TileKey& key)
+    {
+        auto it = tiles.find(key);
+        if (it == tiles.end()) {
+            return nullptr;
+        }
+        it->second.used = ++tick;
+        return it->second.tile;
+    }
+
+    void insert(const TileKey& key, std::shared_ptr<const Tile> tile)
+    {
+        if (tiles.size() >= capacity && tiles.find(key) == tiles.end()) {
+            evict();
+        }
+        tiles[key] = {std::move(tile), ++tick};
+    }
+
+    size_t size() const
+    {
+        return tiles.size();
+    }
+
+    void clear()
+    {
+        tiles.clear();
+    }
+
+private:
+    void evict()
+    {
+        auto oldest = tiles.begin();
+        for (auto it = tiles.begin(); it != tiles.end(); ++it) {
+            if (it->second.used < oldest->second.used) {
+                oldest = it;
+            }
+        }
+        if (oldest != tiles.end()) {
+            tiles.erase(oldest);
+        }
+    }
+
+    struct Entry
+    {
+        std::shared_ptr<const Tile> tile;
+        uint64_t used; // the tick of the last find or insert
+    };
+
+    std::map<TileKey, Entry> tiles;
+    size_t capacity;
+    uint64_t tick{0};
+};
+
+/// Sample spacings per tile
+constexpr int TILE_SAMPLES = 64;
+
+/// Tiles a view spans at most, besides a partial one, well below the default cache capacity so
+/// that the tiles of a few views stay cached while panning
+constexpr int MAX_VIEW_TILES = 32;
+
+/// The zoom level of num_points samples over width, the largest power of two spacing that is at
+/// least as fine. Only crossing a power of two picks a new level, so most changes of the width or
+/// of num_points keep the cached tiles. Beyond TILE_SAMPLES * MAX_VIEW_TILES samples over width
+/// the spacing gets no finer.
+inline int tile_level(float width, int num_points)
+{
+    double view = std::max(static_cast<double>(width), 1.0);
+    int level = static_cast<int>(std::floor(std::log2(view / std::max(num_points - 1, 1))));
+    int coarsest = static_cast<int>(std::ceil(std::log2(view / (TILE_SAMPLES * MAX_VIEW_TILES))));
+    return std::max(level, coarsest);
+}
+
+/// Joins the tiles covering [x_start, x_end] into the polyline out. Tiles missing from the cache
+/// are predicted by predict(x0, x1, num_samples, tile) into a vector of points and inserted.
+/// Neighbouring tiles share their boundary point, which is kept once. Returns the number of tiles
+/// predicted.
+template <typename P, typename Predict>
+int predict_tiled(TileCache<std::vector<P>>& cache, uint64_t version, int level, float x_start,
+                  float x_end, Predict&& predict, std::vector<P>& out)
+{
+    const double width = std::ldexp(static_cast<double>(TILE_SAMPLES), level);
+    const auto first = static_cast<int64_t>(std::floor(x_start / width));
+    const auto last = std::max(first + 1, static_cast<int64_t>(std::ceil(x_end / width)));
+
+    out.clear();
+    int predicted = 0;
+    for (auto i = first; i < last; i++) {
+        TileKey key{version, i, level};
+        auto tile = cache.find(key);
+        if (!tile) {
+            auto fresh = std::make_shared<std::vector<P>>();
+            predict(static_cast<float>(i * width), static_cast<float>((i + 1) * width),
+                    TILE_SAMPLES + 1, *fresh);
+            tile = fresh;
+            cache.insert(key, tile);
+            predicted++;
+        }
+
+        auto begin = tile->begin();
+        if (!out.empty() && begin != tile->end()) {
+            ++begin;
+        }
+        out.insert(out.end(), begin, tile->end());
+    }
+    return predicted;
+}
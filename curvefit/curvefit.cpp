@@ -0,0 +1,575 @@
+// Fits the solvers of hw1 and hw2 to point sets without a window.
+//
+// Each input is a text file of x,y pairs, stdin, or a binary point file written by --pack. The
+// files are fitted concurrently on a thread pool and their predicted curves are written to stdout as
+// x,y lines in the order the files were given, each one as soon as it and the ones before it are
+// done.
+
+#include "hw1/solve.hpp"
+#include "hw2/solve.hpp"
+#include "point_file.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+
+const char* USAGE = R"(usage: curvefit [options] [file ...]
+
+Fits a curve to the x,y points of each file, or of stdin if no file or "-" is given, and writes the
+predicted x,y points to stdout. Lines that do not start with two numbers, such as a header, are
+skipped. The numbers may be separated by commas, semicolons or blanks.
+
+Binary point files are memory mapped instead of parsed, and least-square and ridge read their
+coordinates in place with the statistics stored in the file. Least-square parses a text file chunk
+by chunk as the fit reads it, in two passes, and never holds all of its points; stdin cannot be
+read twice and is parsed up front.
+
+options:
+  -m, --model NAME   monomial, gauss, wendland, least-square, ridge or rbf (default least-square)
+  --order M          order of least-square and ridge (default 3)
+  --sigma S          standard deviation of gauss, support radius of wendland (default 33)
+  --weight A         regularization weight of ridge (default 0.01)
+  --single           sum and solve least-square and ridge in float32 instead of float64, for
+                     points that are parsed rather than mapped
+  --basis N          number of basis of rbf (default 4)
+  -n, --samples N    predicted points per file (default 150)
+  --range X0 X1      the predicted range (default the range of the xs of each file)
+  -j, --threads N    files fitted at once, 0 for every hardware thread (default 0)
+  -t, --timings      report the time of every stage of every file to stderr
+  --pack OUT         write the points of the single input to the binary point file OUT instead
+  --double           store float64 coordinates with --pack, float32 otherwise
+  --sorted           store the permutation that sorts the points by x with --pack
+  -h, --help         print this help
+)";
+
+const char* MODELS[] = {"monomial", "gauss", "wendland", "least-square", "ridge", "rbf"};
+
+struct Options
+{
+    string model{"least-square"};
+    int order{3};
+    float sigma{33};
+    float weight{0.01f};
+    bool single{false};
+    int basis{4};
+    int samples{150};
+    bool has_range{false};
+    float x_start{0};
+    float x_end{0};
+    unsigned threads{0};
+    bool timings{false};
+    string pack;
+    bool pack_double{false};
+    bool pack_sorted{false};
+    vector<string> files;
+};
+
+/// milliseconds spent in each stage
+struct Timings
+{
+    double read{0};
+    double fit{0};
+    double predict{0};
+    double format{0};
+};
+
+/// everything a file produces, written out by the main thread
+struct Output
+{
+    string text;
+    string error;
+    size_t num_points{0};
+    Timings timings;
+};
+
+using Clock = chrono::steady_clock;
+
+double elapsed_ms(Clock::time_point beg)
+{
+    return chrono::duration<double, milli>(Clock::now() - beg).count();
+}
+
+bool parse_point(const string& line, Point& p)
+{
+    const char* s = line.c_str();
+    char* end;
+    p.x = strtof(s, &end);
+    if (end == s) {
+        return false;
+    }
+    s = end;
+    while (*s == ',' || *s == ';' || isspace(static_cast<unsigned char>(*s))) {
+        s++;
+    }
+    p.y = strtof(s, &end);
+    return end != s;
+}
+
+vector<Point> read_points(istream& in)
+{
+    vector<Point> points;
+    string line;
+    Point p;
+    while (getline(in, line)) {
+        if (parse_point(line, p)) {
+            points.push_back(p);
+        }
+    }
+    return points;
+}
+
+/// Parses the points of a text file a chunk at a time for the streamed least-square fit. The count
+/// and the x range of the points are noted on the first pass.
+class TextPointSource : public PointSource
+{
+public:
+    explicit TextPointSource(const string& path)
+        : in{path}
+    {
+    }
+
+    bool is_open() const
+    {
+        return static_cast<bool>(in);
+    }
+
+    size_t fill(Point* buf, size_t capacity) override
+    {
+        size_t n = 0;
+        Point p;
+        while (n < capacity && getline(in, line)) {
+            if (parse_point(line, p)) {
+                buf[n++] = p;
+            }
+        }
+        if (passes == 1) {
+            for (size_t i = 0; i < n; i++) {
+                x_min = min(x_min, buf[i].x);
+                x_max = max(x_max, buf[i].x);
+            }
+            count += n;
+        }
+        return n;
+    }
+
+    void rewind() override
+    {
+        in.clear();
+        in.seekg(0);
+        passes++;
+    }
+
+    size_t count{0};
+    float x_min{INFINITY};
+    float x_max{-INFINITY};
+
+private:
+    ifstream in;
+    string line;
+    int passes{0}; // the rewinds so far, each starts a pass
+};
+
+bool is_point_file(const string& path)
+{
+    char magic[sizeof(POINT_FILE_MAGIC)] = {};
+    ifstream in(path, ios::binary);
+    in.read(magic, sizeof(magic));
+    return in && equal(begin(magic), end(magic), begin(POINT_FILE_MAGIC));
+}
+
+/// Times make(), which returns a solver, and the solver's predict
+template <typename Make>
+vector<Point> fit_predict(Make&& make, const Options& opts, float x_start, float x_end,
+                          Timings& timings)
+{
+    auto beg = Clock::now();
+    auto solver = make();
+    timings.fit = elapsed_ms(beg);
+
+    beg = Clock::now();
+    auto curve = solver.predict(x_start, x_end, opts.samples);
+    timings.predict = elapsed_ms(beg);
+    return curve;
+}
+
+vector<Point> fit_predict(const Options& opts, const vector<Point>& points, float x_start,
+                          float x_end, Timings& timings)
+{
+    auto run = [&](auto&& make) { return fit_predict(make, opts, x_start, x_end, timings); };
+
+    if (opts.model == "monomial") {
+        return run([&] { return MonomialInterpolation(points); });
+    }
+    if (opts.model == "gauss") {
+        return run([&] { return GaussInterpolation(opts.sigma, points); });
+    }
+    if (opts.model == "wendland") {
+        return run([&] { return WendlandInterpolation(opts.sigma, points); });
+    }
+    if (opts.model == "least-square" && opts.single) {
+        return run([&] { return BasicLeastSquare<float>(opts.order, points); });
+    }
+    if (opts.model == "least-square") {
+        return run([&] { return LeastSquare(opts.order, points); });
+    }
+    if (opts.model == "ridge" && opts.single) {
+        return run([&] { return BasicRidgeRegression<float>(opts.order, opts.weight, points); });
+    }
+    if (opts.model == "ridge") {
+        return run([&] { return RidgeRegression(opts.order, opts.weight, points); });
+    }
+    return run([&] {
+        RBFNetwork net(opts.basis);
+        net.verbose = false;
+        net.fit(make_shared<AdamOptimizer>(0.1f), points);
+        return net;
+    });
+}
+
+/// Fits least-square to the points of the source as it parses them. Their count and range are only
+/// known after the fit, the fit time includes the parse.
+vector<Point> fit_predict(const Options& opts, TextPointSource& source,
+                          const StreamOptions& stream, Output& out)
+{
+    auto beg = Clock::now();
+    LeastSquare solver(opts.order, source, stream);
+    out.timings.fit = elapsed_ms(beg);
+    out.num_points = source.count;
+    if (out.num_points < 2) {
+        return {};
+    }
+
+    beg = Clock::now();
+    float x_start = opts.has_range ? opts.x_start : source.x_min;
+    float x_end = opts.has_range ? opts.x_end : source.x_max;
+    auto curve = solver.predict(x_start, x_end, opts.samples);
+    out.timings.predict = elapsed_ms(beg);
+    return curve;
+}
+
+/// Fits least-square or ridge to the coordinates of the file in place
+template <typename Scalar>
+vector<Point> fit_predict(const Options& opts, const MappedPointFile& file,
+                          const StreamOptions& stream, float x_start, float x_end,
+                          Timings& timings)
+{
+    auto xs = file.xs<Scalar>();
+    auto ys = file.ys<Scalar>();
+    auto norm = file.normalizer();
+    if (opts.model == "least-square") {
+        return fit_predict([&] { return LeastSquare(opts.order, xs, ys, norm, stream); }, opts,
+                           x_start, x_end, timings);
+    }
+    return fit_predict(
+        [&] { return RidgeRegression(opts.order, opts.weight, xs, ys, norm, stream); }, opts,
+        x_start, x_end, timings);
+}
+
+template <typename Scalar>
+void x_range(const MappedPointFile& file, float& x_start, float& x_end)
+{
+    auto xs = file.xs<Scalar>();
+    const size_t n = file.size();
+    auto order = file.order();
+    // the stored order is not validated on open, a corrupted one falls back to the scan
+    if (order && n > 0 && order[0] < n && order[n - 1] < n) {
+        x_start = static_cast<float>(xs(order[0]));
+        x_end = static_cast<float>(xs(order[n - 1]));
+    }
+    else {
+        x_start = static_cast<float>(xs.minCoeff());
+        x_end = static_cast<float>(xs.maxCoeff());
+    }
+}
+
+StreamOptions stream_options(const Options& opts)
+{
+    // with several files the threads are already busy with one file each
+    StreamOptions stream;
+    stream.num_threads = opts.files.size() > 1 ? 1 : static_cast<int>(opts.threads);
+    return stream;
+}
+
+void format_curve(const vector<Point>& curve, Output& out)
+{
+    auto beg = Clock::now();
+    char line[64];
+    out.text.reserve(curve.size() * 24);
+    for (const auto& p : curve) {
+        int len = snprintf(line, sizeof(line), "%.9g,%.9g\n", p.x, p.y);
+        out.text.append(line, len);
+    }
+    out.timings.format = elapsed_ms(beg);
+}
+
+Output run(const Options& opts, const string& file)
+{
+    Output out;
+
+    auto beg = Clock::now();
+    vector<Point> points;
+    MappedPointFile mapped;
+    bool in_place = false; // fitted from the mapped coordinates, points stays empty
+    if (file == "-") {
+        points = read_points(cin);
+    }
+    else if (is_point_file(file)) {
+        if (!mapped.open(file, out.error)) {
+            return out;
+        }
+        in_place = opts.pack.empty() && (opts.model == "least-square" || opts.model == "ridge");
+        if (!in_place) {
+            mapped.copy_to(points);
+        }
+    }
+    else if (opts.pack.empty() && opts.model == "least-square" && !opts.single) {
+        TextPointSource source{file};
+        if (!source.is_open()) {
+            out.error = "cannot open " + file;
+            return out;
+        }
+        auto curve = fit_predict(opts, source, stream_options(opts), out);
+        if (out.num_points < 2) {
+            out.error = file + ": needs at least two points";
+            return out;
+        }
+        format_curve(curve, out);
+        return out;
+    }
+    else {
+        ifstream in(file);
+        if (!in) {
+            out.error = "cannot open " + file;
+            return out;
+        }
+        points = read_points(in);
+    }
+    out.timings.read = elapsed_ms(beg);
+    out.num_points = in_place ? mapped.size() : points.size();
+
+    if (out.num_points < 2) {
+        out.error = file + ": needs at least two points";
+        return out;
+    }
+
+    if (!opts.pack.empty()) {
+        bool ok = opts.pack_double
+                      ? write_point_file<double>(opts.pack, points, opts.pack_sorted, out.error)
+                      : write_point_file<float>(opts.pack, points, opts.pack_sorted, out.error);
+        out.timings.format = elapsed_ms(beg) - out.timings.read;
+        if (!ok) {
+            out.error = "cannot pack " + file + ": " + out.error;
+        }
+        return out;
+    }
+
+    float x_start = opts.x_start;
+    float x_end = opts.x_end;
+    if (!opts.has_range && in_place) {
+        if (mapped.is_double())
+            x_range<double>(mapped, x_start, x_end);
+        else
+            x_range<float>(mapped, x_start, x_end);
+    }
+    else if (!opts.has_range) {
+        auto [lo, hi] = minmax_element(points.begin(), points.end(),
+                                       [](const Point& a, const Point& b) { return a.x < b.x; });
+        x_start = lo->x;
+        x_end = hi->x;
+    }
+
+    vector<Point> curve;
+    if (in_place) {
+        auto stream = stream_options(opts);
+        curve = mapped.is_double()
+                    ? fit_predict<double>(opts, mapped, stream, x_start, x_end, out.timings)
+                    : fit_predict<float>(opts, mapped, stream, x_start, x_end, out.timings);
+    }
+    else {
+        curve = fit_predict(opts, points, x_start, x_end, out.timings);
+    }
+
+    format_curve(curve, out);
+    return out;
+}
+
+[[noreturn]] void usage_error(const string& message)
+{
+    cerr << "curvefit: " << message << "\n\n" << USAGE;
+    exit(2);
+}
+
+Options parse_args(int argc, char** argv)
+{
+    Options opts;
+    auto value = [&](int& i) -> string {
+        if (i + 1 >= argc) {
+            usage_error(string{"missing value of "} + argv[i]);
+        }
+        return argv[++i];
+    };
+    auto number = [&](int& i) {
+        const char* name = argv[i];
+        string s = value(i);
+        char* end;
+        double x = strtod(s.c_str(), &end);
+        if (s.empty() || *end) {
+            usage_error(string{"invalid value of "} + name + ": " + s);
+        }
+        return x;
+    };
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            cout << USAGE;
+            exit(0);
+        }
+        else if (arg == "-m" || arg == "--model") {
+            opts.model = value(i);
+        }
+        else if (arg == "--order") {
+            opts.order = static_cast<int>(number(i));
+        }
+        else if (arg == "--sigma") {
+            opts.sigma = static_cast<float>(number(i));
+        }
+        else if (arg == "--weight") {
+            opts.weight = static_cast<float>(number(i));
+        }
+        else if (arg == "--single") {
+            opts.single = true;
+        }
+        else if (arg == "--basis") {
+            opts.basis = static_cast<int>(number(i));
+        }
+        else if (arg == "-n" || arg == "--samples") {
+            opts.samples = static_cast<int>(number(i));
+        }
+        else if (arg == "--range") {
+            opts.x_start = static_cast<float>(number(i));
+            opts.x_end = static_cast<float>(number(i));
+            opts.has_range = true;
+        }
+        else if (arg == "-j" || arg == "--threads") {
+            double threads = number(i);
+            if (threads < 0) {
+                usage_error("--threads cannot be negative");
+            }
+            opts.threads = static_cast<unsigned>(threads);
+        }
+        else if (arg == "-t" || arg == "--timings") {
+            opts.timings = true;
+        }
+        else if (arg == "--pack") {
+            opts.pack = value(i);
+        }
+        else if (arg == "--double") {
+            opts.pack_double = true;
+        }
+        else if (arg == "--sorted") {
+            opts.pack_sorted = true;
+        }
+        else if (arg.size() > 1 && arg[0] == '-') {
+            usage_error("unknown option " + arg);
+        }
+        else {
+            opts.files.push_back(arg);
+        }
+    }
+
+    if (find(begin(MODELS), end(MODELS), opts.model) == end(MODELS)) {
+        usage_error("unknown model " + opts.model);
+    }
+    if (opts.samples < 2) {
+        usage_error("--samples needs at least 2");
+    }
+    if (opts.order < 0) {
+        usage_error("--order cannot be negative");
+    }
+    if (!(opts.sigma > 0)) {
+        usage_error("--sigma needs to be positive");
+    }
+    if (!(opts.weight >= 0)) {
+        usage_error("--weight cannot be negative");
+    }
+    if (opts.basis < 1) {
+        usage_error("--basis needs at least 1");
+    }
+    if (opts.files.empty()) {
+        opts.files.push_back("-");
+    }
+    if (count(opts.files.begin(), opts.files.end(), "-") > 1) {
+        usage_error("stdin can only be read once");
+    }
+    if (!opts.pack.empty() && opts.files.size() > 1) {
+        usage_error("--pack takes a single input");
+    }
+    return opts;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const auto opts = parse_args(argc, argv);
+    const auto beg = Clock::now();
+
+    ThreadPool pool{opts.threads};
+    vector<future<Output>> outputs;
+    for (const auto& file : opts.files) {
+        outputs.push_back(pool.submit([&opts, file] { return run(opts, file); }));
+    }
+
+    int status = 0;
+    Timings total;
+    for (size_t i = 0; i < outputs.size(); i++) {
+        auto out = outputs[i].get();
+        const auto& file = opts.files[i];
+        if (!out.error.empty()) {
+            cerr << "curvefit: " << out.error << endl;
+            status = 1;
+            continue;
+        }
+
+        if (opts.files.size() > 1) {
+            cout << "# " << file << '\n';
+        }
+        cout << out.text << flush;
+
+        const auto& t = out.timings;
+        if (opts.timings) {
+            fprintf(stderr,
+                    "%s: %zu points, read %.3f ms, fit %.3f ms, predict %.3f ms, format %.3f ms\n",
+                    file.c_str(), out.num_points, t.read, t.fit, t.predict, t.format);
+        }
+        total.read += t.read;
+        total.fit += t.fit;
+        total.predict += t.predict;
+        total.format += t.format;
+    }
+
+    if (opts.timings) {
+        fprintf(stderr,
+                "total: %zu files on %zu threads in %.3f ms, read %.3f ms, fit %.3f ms, "
+                "predict %.3f ms, format %.3f ms\n",
+                opts.files.size(), pool.size(), elapsed_ms(beg), total.read, total.fit,
+                total.predict, total.format);
+    }
+    return status;
+}
@@ -0,0 +1,439 @@
+// dear imgui: Renderer for a CPU rasterizer (headless, no GPU or display needed)
+// This needs to be used along with a Platform Binding, or with code filling io.DisplaySize, io.DeltaTime and the mouse state itself.
+
+// Implemented features:
+//  [X] Renderer: User texture binding. Use 'ImGui_ImplSoft_Texture*' as ImTextureID. Read the FAQ about ImTextureID!
+//  [X] Renderer: Support for large meshes (64k+ vertices) with 16-bit indices.
+//  [X] Renderer: Multi-threaded rasterization by screen tiles.
+
+// How it works:
+// - RenderDrawData() first walks the command lists in order and appends every triangle, projected to framebuffer space
+//   with its scissor rectangle and texture, to the bins of the screen tiles its bounding box touches.
+// - The tiles are then rasterized in parallel, each by one thread, which blends the triangles of its bin in submission
+//   order. A pixel belongs to exactly one tile, so the result does not depend on the number of threads.
+// - User callbacks are called during the first pass, before any pixel of the frame is written.
+
+#include "imgui.h"
+#include "imgui_impl_soft.h"
+#include <math.h>       // floorf
+#include <algorithm>    // std::min, std::max, std::swap
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A triangle ready to rasterize
+struct ImGui_ImplSoft_Triangle
+{
+    int                             X[3];       // In framebuffer space, in 1/SUBPIXELS of a pixel, counter-clockwise (positive area)
+    int                             Y[3];
+    ImVec2                          Uv[3];
+    ImU32                           Col[3];
+    const ImGui_ImplSoft_Texture*   Texture;    // NULL: white
+    int                             ClipMin[2]; // Scissor rectangle, in pixels
+    int                             ClipMax[2];
+    bool                            Flat;       // Same color and uv at every corner
+};
+
+// Renderer data
+static const int                        TILE_SIZE = 64;
+static const int                        SUBPIXELS = 256;        // Vertices are snapped to 1/256 pixel, so that edge functions are exact
+static const float                      MAX_COORD = 4000000.0f; // Pixels, keeps the products of the edge functions within 64 bits
+static ImGui_ImplSoft_Texture           g_FontTexture = { NULL, 0, 0 };
+static ImVector<ImU32>                  g_Pixels;
+static int                              g_Width = 0;
+static int                              g_Height = 0;
+static int                              g_TilesX = 0;
+static int                              g_TilesY = 0;
+static ImVector<ImGui_ImplSoft_Triangle> g_Triangles;
+static std::vector<std::vector<int> >   g_Bins;         // Indices into g_Triangles, per tile
+static ImU32                            g_ClearCol = 0;
+
+// Worker threads, woken once per frame
+static std::vector<std::thread>         g_Workers;
+static std::mutex                       g_WorkersMutex;
+static std::condition_variable          g_WorkersWake;
+static std::condition_variable          g_WorkersDone;
+static int                              g_WorkersGeneration = 0;
+static int                              g_WorkersBusy = 0;
+static bool                             g_WorkersQuit = false;
+static std::atomic<int>                 g_NextTile(0);
+
+// Functions
+static void ImGui_ImplSoft_RasterizeTiles();
+
+static void ImGui_ImplSoft_WorkerMain()
+{
+    int generation = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(g_WorkersMutex);
+            g_WorkersWake.wait(lock, [&] { return g_WorkersQuit || g_WorkersGeneration != generation; });
+            if (g_WorkersQuit)
+                return;
+            generation = g_WorkersGeneration;
+        }
+        ImGui_ImplSoft_RasterizeTiles();
+        {
+            std::lock_guard<std::mutex> lock(g_WorkersMutex);
+            if (--g_WorkersBusy == 0)
+                g_WorkersDone.notify_one();
+        }
+    }
+}
+
+bool    ImGui_ImplSoft_Init(int threads_count)
+{
+    // Setup back-end capabilities flags
+    ImGuiIO& io = ImGui::GetIO();
+    io.BackendRendererName = "imgui_impl_soft";
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;  // We can honor the ImDrawCmd::VtxOffset field, allowing for large meshes.
+
+    if (threads_count <= 0)
+        threads_count = std::max((int)std::thread::hardware_concurrency(), 1);
+    g_WorkersQuit = false;
+    for (int i = 1; i < threads_count; i++) // The thread calling RenderDrawData() is the first one
+        g_Workers.push_back(std::thread(ImGui_ImplSoft_WorkerMain));
+    return true;
+}
+
+void    ImGui_ImplSoft_Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(g_WorkersMutex);
+        g_WorkersQuit = true;
+    }
+    g_WorkersWake.notify_all();
+    for (size_t i = 0; i < g_Workers.size(); i++)
+        g_Workers[i].join();
+    g_Workers.clear();
+
+    ImGui_ImplSoft_DestroyFontsTexture();
+    g_Pixels.clear();
+    g_Triangles.clear();
+    g_Bins.clear();
+}
+
+void    ImGui_ImplSoft_NewFrame()
+{
+    if (!g_FontTexture.Pixels)
+        ImGui_ImplSoft_CreateFontsTexture();
+}
+
+bool    ImGui_ImplSoft_CreateFontsTexture()
+{
+    // The atlas keeps its pixels, which we sample in place
+    ImGuiIO& io = ImGui::GetIO();
+    unsigned char* pixels;
+    int width, height;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    g_FontTexture.Pixels = pixels;
+    g_FontTexture.Width = width;
+    g_FontTexture.Height = height;
+    io.Fonts->TexID = (ImTextureID)&g_FontTexture;
+    return true;
+}
+
+void    ImGui_ImplSoft_DestroyFontsTexture()
+{
+    if (g_FontTexture.Pixels)
+    {
+        ImGuiIO& io = ImGui::GetIO();
+        io.Fonts->TexID = 0;
+        g_FontTexture.Pixels = NULL;
+    }
+}
+
+const ImU32* ImGui_ImplSoft_GetPixels(int* out_width, int* out_height)
+{
+    if (out_width) *out_width = g_Width;
+    if (out_height) *out_height = g_Height;
+    return g_Pixels.Data;
+}
+
+static inline int ImGui_ImplSoft_Clamp(int v, int lo, int hi)
+{
+    return v < lo ? lo : v > hi ? hi : v;
+}
+
+static inline float ImGui_ImplSoft_Clamp(float v, float lo, float hi)
+{
+    return v < lo ? lo : v > hi ? hi : v;
+}
+
+// Edge function: twice the signed area of (a, b, p), positive for the inside of a counter-clockwise triangle in a y-down space
+static inline ImS64 ImGui_ImplSoft_Edge(int ax, int ay, int bx, int by, int px, int py)
+{
+    return (ImS64)(bx - ax) * (py - ay) - (ImS64)(by - ay) * (px - ax);
+}
+
+// Top-left rule: pixel centers on a top or a left edge belong to the triangle, those on the other edges don't
+static inline bool ImGui_ImplSoft_IsTopLeft(int ax, int ay, int bx, int by)
+{
+    return (ay == by && bx > ax) || by < ay;
+}
+
+// Bilinear, clamped to the edges, as GL_LINEAR with GL_CLAMP_TO_EDGE. Returns the 4 channels in 0..1.
+static inline void ImGui_ImplSoft_Sample(const ImGui_ImplSoft_Texture* tex, float u, float v, float out[4])
+{
+    float x = u * tex->Width - 0.5f;
+    float y = v * tex->Height - 0.5f;
+    int x0 = (int)floorf(x);
+    int y0 = (int)floorf(y);
+    const float fx = x - x0;
+    const float fy = y - y0;
+    const int x1 = ImGui_ImplSoft_Clamp(x0 + 1, 0, tex->Width - 1);
+    const int y1 = ImGui_ImplSoft_Clamp(y0 + 1, 0, tex->Height - 1);
+    x0 = ImGui_ImplSoft_Clamp(x0, 0, tex->Width - 1);
+    y0 = ImGui_ImplSoft_Clamp(y0, 0, tex->Height - 1);
+    const unsigned char* p00 = tex->Pixels + (y0 * tex->Width + x0) * 4;
+    const unsigned char* p10 = tex->Pixels + (y0 * tex->Width + x1) * 4;
+    const unsigned char* p01 = tex->Pixels + (y1 * tex->Width + x0) * 4;
+    const unsigned char* p11 = tex->Pixels + (y1 * tex->Width + x1) * 4;
+    for (int c = 0; c < 4; c++)
+    {
+        const float top = p00[c] + (p10[c] - p00[c]) * fx;
+        const float bottom = p01[c] + (p11[c] - p01[c]) * fx;
+        out[c] = (top + (bottom - top) * fy) * (1.0f / 255.0f);
+    }
+}
+
+// Blend src (0..1, not premultiplied) over *dst, with SRC_ALPHA, ONE_MINUS_SRC_ALPHA for all channels
+static inline void ImGui_ImplSoft_Blend(ImU32* dst, const float src[4])
+{
+    const float a = src[3];
+    if (a <= 0.0f)
+        return;
+    const ImU32 d = *dst;
+    ImU32 out = 0;
+    for (int c = 0; c < 4; c++)
+    {
+        const float dc = (float)((d >> (c * 8)) & 0xFF);
+        const float oc = src[c] * 255.0f * a + dc * (1.0f - a);
+        out |= (ImU32)ImGui_ImplSoft_Clamp((int)(oc + 0.5f), 0, 255) << (c * 8);
+    }
+    *dst = out;
+}
+
+static void ImGui_ImplSoft_RasterizeTriangle(const ImGui_ImplSoft_Triangle& tri, int tile_x0, int tile_y0, int tile_x1, int tile_y1)
+{
+    const int* X = tri.X;
+    const int* Y = tri.Y;
+
+    // Pixels whose centers may be covered, within the tile and the scissor rectangle
+    const int x0 = std::max(std::max(tile_x0, tri.ClipMin[0]), std::min(X[0], std::min(X[1], X[2])) / SUBPIXELS - 1);
+    const int y0 = std::max(std::max(tile_y0, tri.ClipMin[1]), std::min(Y[0], std::min(Y[1], Y[2])) / SUBPIXELS - 1);
+    const int x1 = std::min(std::min(tile_x1, tri.ClipMax[0]), std::max(X[0], std::max(X[1], X[2])) / SUBPIXELS + 2);
+    const int y1 = std::min(std::min(tile_y1, tri.ClipMax[1]), std::max(Y[0], std::max(Y[1], Y[2])) / SUBPIXELS + 2);
+    if (x0 >= x1 || y0 >= y1)
+        return;
+
+    // A pixel center on an edge that is not top-left is outside: its edge function must reach 1, not 0
+    const float inv_area = 1.0f / (float)ImGui_ImplSoft_Edge(X[0], Y[0], X[1], Y[1], X[2], Y[2]);
+    const ImS64 bias0 = ImGui_ImplSoft_IsTopLeft(X[1], Y[1], X[2], Y[2]) ? 0 : 1;
+    const ImS64 bias1 = ImGui_ImplSoft_IsTopLeft(X[2], Y[2], X[0], Y[0]) ? 0 : 1;
+    const ImS64 bias2 = ImGui_ImplSoft_IsTopLeft(X[0], Y[0], X[1], Y[1]) ? 0 : 1;
+
+    // Corner colors in 0..1
+    float col[3][4];
+    for (int k = 0; k < 3; k++)
+        for (int c = 0; c < 4; c++)
+            col[k][c] = (float)((tri.Col[k] >> (c * 8)) & 0xFF) * (1.0f / 255.0f);
+
+    // A flat triangle has the same source color at every pixel, the common case of solid fills and fringes-less shapes
+    float flat_src[4];
+    if (tri.Flat)
+    {
+        float texel[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        if (tri.Texture)
+            ImGui_ImplSoft_Sample(tri.Texture, tri.Uv[0].x, tri.Uv[0].y, texel);
+        for (int c = 0; c < 4; c++)
+            flat_src[c] = col[0][c] * texel[c];
+    }
+
+    // The edge functions at the pixel centers, exact in integers, step by these per pixel
+    const ImS64 w0_dx = -(ImS64)(Y[2] - Y[1]) * SUBPIXELS;
+    const ImS64 w1_dx = -(ImS64)(Y[0] - Y[2]) * SUBPIXELS;
+    const ImS64 w2_dx = -(ImS64)(Y[1] - Y[0]) * SUBPIXELS;
+    for (int y = y0; y < y1; y++)
+    {
+        const int py = y * SUBPIXELS + SUBPIXELS / 2;
+        const int px = x0 * SUBPIXELS + SUBPIXELS / 2;
+        ImS64 w0 = ImGui_ImplSoft_Edge(X[1], Y[1], X[2], Y[2], px, py) - bias0;
+        ImS64 w1 = ImGui_ImplSoft_Edge(X[2], Y[2], X[0], Y[0], px, py) - bias1;
+        ImS64 w2 = ImGui_ImplSoft_Edge(X[0], Y[0], X[1], Y[1], px, py) - bias2;
+        ImU32* dst = g_Pixels.Data + y * g_Width + x0;
+        for (int x = x0; x < x1; x++, dst++, w0 += w0_dx, w1 += w1_dx, w2 += w2_dx)
+        {
+            if ((w0 | w1 | w2) < 0)
+                continue;
+            if (tri.Flat)
+            {
+                ImGui_ImplSoft_Blend(dst, flat_src);
+                continue;
+            }
+
+            // Barycentric interpolation of color and uv (screen space, as ImGui draws in 2D)
+            const float l0 = (float)(w0 + bias0) * inv_area;
+            const float l1 = (float)(w1 + bias1) * inv_area;
+            const float l2 = 1.0f - l0 - l1;
+            float texel[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+            if (tri.Texture)
+            {
+                const float u = l0 * tri.Uv[0].x + l1 * tri.Uv[1].x + l2 * tri.Uv[2].x;
+                const float v = l0 * tri.Uv[0].y + l1 * tri.Uv[1].y + l2 * tri.Uv[2].y;
+                ImGui_ImplSoft_Sample(tri.Texture, u, v, texel);
+            }
+            float src[4];
+            for (int c = 0; c < 4; c++)
+                src[c] = (l0 * col[0][c] + l1 * col[1][c] + l2 * col[2][c]) * texel[c];
+            ImGui_ImplSoft_Blend(dst, src);
+        }
+    }
+}
+
+// Claim tiles until none is left, clear each and blend its triangles in order
+static void ImGui_ImplSoft_RasterizeTiles()
+{
+    const int tiles_count = g_TilesX * g_TilesY;
+    for (int tile = g_NextTile.fetch_add(1); tile < tiles_count; tile = g_NextTile.fetch_add(1))
+    {
+        const int tile_x0 = (tile % g_TilesX) * TILE_SIZE;
+        const int tile_y0 = (tile / g_TilesX) * TILE_SIZE;
+        const int tile_x1 = std::min(tile_x0 + TILE_SIZE, g_Width);
+        const int tile_y1 = std::min(tile_y0 + TILE_SIZE, g_Height);
+        for (int y = tile_y0; y < tile_y1; y++)
+        {
+            ImU32* row = g_Pixels.Data + y * g_Width;
+            for (int x = tile_x0; x < tile_x1; x++)
+                row[x] = g_ClearCol;
+        }
+
+        const std::vector<int>& bin = g_Bins[tile];
+        for (size_t i = 0; i < bin.size(); i++)
+            ImGui_ImplSoft_RasterizeTriangle(g_Triangles[bin[i]], tile_x0, tile_y0, tile_x1, tile_y1);
+    }
+}
+
+static void ImGui_ImplSoft_AddTriangle(const ImDrawVert& v0, const ImDrawVert& v1, const ImDrawVert& v2, const ImVec2& clip_off, const ImVec2& clip_scale, const ImGui_ImplSoft_Texture* texture, const int clip_min[2], const int clip_max[2])
+{
+    ImGui_ImplSoft_Triangle tri;
+    const ImDrawVert* v[3] = { &v0, &v1, &v2 };
+    for (int k = 0; k < 3; k++)
+    {
+        const float x = ImGui_ImplSoft_Clamp((v[k]->pos.x - clip_off.x) * clip_scale.x, -MAX_COORD, MAX_COORD);
+        const float y = ImGui_ImplSoft_Clamp((v[k]->pos.y - clip_off.y) * clip_scale.y, -MAX_COORD, MAX_COORD);
+        tri.X[k] = (int)floorf(x * SUBPIXELS + 0.5f);
+        tri.Y[k] = (int)floorf(y * SUBPIXELS + 0.5f);
+        tri.Uv[k] = v[k]->uv;
+        tri.Col[k] = v[k]->col;
+    }
+
+    // Make it counter-clockwise, drop degenerate ones
+    const ImS64 area = ImGui_ImplSoft_Edge(tri.X[0], tri.Y[0], tri.X[1], tri.Y[1], tri.X[2], tri.Y[2]);
+    if (area == 0)
+        return;
+    if (area < 0)
+    {
+        std::swap(tri.X[1], tri.X[2]);
+        std::swap(tri.Y[1], tri.Y[2]);
+        std::swap(tri.Uv[1], tri.Uv[2]);
+        std::swap(tri.Col[1], tri.Col[2]);
+    }
+    if (((tri.Col[0] | tri.Col[1] | tri.Col[2]) & IM_COL32_A_MASK) == 0)
+        return;
+
+    tri.Texture = texture;
+    tri.ClipMin[0] = clip_min[0]; tri.ClipMin[1] = clip_min[1];
+    tri.ClipMax[0] = clip_max[0]; tri.ClipMax[1] = clip_max[1];
+    tri.Flat = tri.Col[0] == tri.Col[1] && tri.Col[0] == tri.Col[2] &&
+               tri.Uv[0].x == tri.Uv[1].x && tri.Uv[0].x == tri.Uv[2].x && tri.Uv[0].y == tri.Uv[1].y && tri.Uv[0].y == tri.Uv[2].y;
+
+    // Bin by bounding box, within the scissor rectangle
+    const int x0 = std::max(std::min(tri.X[0], std::min(tri.X[1], tri.X[2])) / SUBPIXELS - 1, clip_min[0]);
+    const int y0 = std::max(std::min(tri.Y[0], std::min(tri.Y[1], tri.Y[2])) / SUBPIXELS - 1, clip_min[1]);
+    const int x1 = std::min(std::max(tri.X[0], std::max(tri.X[1], tri.X[2])) / SUBPIXELS + 2, clip_max[0]);
+    const int y1 = std::min(std::max(tri.Y[0], std::max(tri.Y[1], tri.Y[2])) / SUBPIXELS + 2, clip_max[1]);
+    if (x0 >= x1 || y0 >= y1)
+        return;
+
+    const int index = g_Triangles.Size;
+    g_Triangles.push_back(tri);
+    for (int ty = y0 / TILE_SIZE; ty <= (y1 - 1) / TILE_SIZE; ty++)
+        for (int tx = x0 / TILE_SIZE; tx <= (x1 - 1) / TILE_SIZE; tx++)
+            g_Bins[ty * g_TilesX + tx].push_back(index);
+}
+
+void    ImGui_ImplSoft_RenderDrawData(ImDrawData* draw_data, ImU32 clear_col)
+{
+    // Avoid rendering when minimized, scale coordinates for retina displays (screen coordinates != framebuffer coordinates)
+    const int fb_width = (int)(draw_data->DisplaySize.x * draw_data->FramebufferScale.x);
+    const int fb_height = (int)(draw_data->DisplaySize.y * draw_data->FramebufferScale.y);
+    if (fb_width <= 0 || fb_height <= 0)
+        return;
+
+    if (fb_width != g_Width || fb_height != g_Height)
+    {
+        g_Width = fb_width;
+        g_Height = fb_height;
+        g_Pixels.resize(fb_width * fb_height);
+        g_TilesX = (fb_width + TILE_SIZE - 1) / TILE_SIZE;
+        g_TilesY = (fb_height + TILE_SIZE - 1) / TILE_SIZE;
+        g_Bins.resize((size_t)(g_TilesX * g_TilesY));
+    }
+    g_ClearCol = clear_col;
+    g_Triangles.resize(0);
+    for (size_t i = 0; i < g_Bins.size(); i++)
+        g_Bins[i].clear();
+
+    // Will project scissor/clipping rectangles into framebuffer space
+    ImVec2 clip_off = draw_data->DisplayPos;         // (0,0) unless using multi-viewports
+    ImVec2 clip_scale = draw_data->FramebufferScale; // (1,1) unless using retina display which are often (2,2)
+
+    // Bin the triangles of every command list, in order
+    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++)
+        {
+            const ImDrawCmd* pcmd = &cmd_list->CmdBuffer[cmd_i];
+            if (pcmd->UserCallback)
+            {
+                // User callback, registered via ImDrawList::AddCallback()
+                // (ImDrawCallback_ResetRenderState is a special callback value used by the user to request the renderer to reset render state, we have none.)
+                if (pcmd->UserCallback != ImDrawCallback_ResetRenderState)
+                    pcmd->UserCallback(cmd_list, pcmd);
+                continue;
+            }
+
+            // Project scissor/clipping rectangles into framebuffer space, truncated as by glScissor()
+            int clip_min[2], clip_max[2];
+            clip_min[0] = std::max((int)((pcmd->ClipRect.x - clip_off.x) * clip_scale.x), 0);
+            clip_min[1] = std::max((int)((pcmd->ClipRect.y - clip_off.y) * clip_scale.y), 0);
+            clip_max[0] = std::min((int)((pcmd->ClipRect.z - clip_off.x) * clip_scale.x), fb_width);
+            clip_max[1] = std::min((int)((pcmd->ClipRect.w - clip_off.y) * clip_scale.y), fb_height);
+            if (clip_min[0] >= clip_max[0] || clip_min[1] >= clip_max[1])
+                continue;
+
+            const ImGui_ImplSoft_Texture* texture = (const ImGui_ImplSoft_Texture*)pcmd->TextureId;
+            const ImDrawVert* vtx = cmd_list->VtxBuffer.Data + pcmd->VtxOffset;
+            const ImDrawIdx* idx = cmd_list->IdxBuffer.Data + pcmd->IdxOffset;
+            for (unsigned int i = 0; i + 2 < pcmd->ElemCount; i += 3)
+                ImGui_ImplSoft_AddTriangle(vtx[idx[i]], vtx[idx[i + 1]], vtx[idx[i + 2]], clip_off, clip_scale, texture, clip_min, clip_max);
+        }
+    }
+
+    // Rasterize the tiles on every thread, this one included
+    g_NextTile = 0;
+    {
+        std::lock_guard<std::mutex> lock(g_WorkersMutex);
+        g_WorkersGeneration++;
+        g_WorkersBusy = (int)g_Workers.size();
+    }
+    g_WorkersWake.notify_all();
+    ImGui_ImplSoft_RasterizeTiles();
+    std::unique_lock<std::mutex> lock(g_WorkersMutex);
+    g_WorkersDone.wait(lock, [] { return g_WorkersBusy == 0; });
+}
@@ -0,0 +1,35 @@
+// dear imgui: Renderer for a CPU rasterizer (headless, no GPU or display needed)
+// This needs to be used along with a Platform Binding, or with code filling io.DisplaySize, io.DeltaTime and the mouse state itself.
+
+// Implemented features:
+//  [X] Renderer: User texture binding. Use 'ImGui_ImplSoft_Texture*' as ImTextureID. Read the FAQ about ImTextureID!
+//  [X] Renderer: Support for large meshes (64k+ vertices) with 16-bit indices.
+//  [X] Renderer: Multi-threaded rasterization by screen tiles.
+
+// The triangles of ImDrawData are rasterized into an RGBA8 buffer owned by the back-end, with scissor rectangles,
+// bilinear texture sampling and the same alpha blending as the OpenGL back-ends. Meant for benchmarks and image
+// regression tests, it favors predictable output over speed: pixel centers are at +0.5 and shared triangle edges
+// follow the top-left rule, so every pixel is blended once per covering triangle, as on a GPU.
+
+#pragma once
+#include "imgui.h"      // IMGUI_IMPL_API
+
+// A texture the back-end can sample: pass a pointer to one as ImTextureID.
+struct ImGui_ImplSoft_Texture
+{
+    const unsigned char*    Pixels;         // RGBA8, rows top to bottom
+    int                     Width;
+    int                     Height;
+};
+
+IMGUI_IMPL_API bool     ImGui_ImplSoft_Init(int threads_count = 0);     // 0: one thread per hardware thread
+IMGUI_IMPL_API void     ImGui_ImplSoft_Shutdown();
+IMGUI_IMPL_API void     ImGui_ImplSoft_NewFrame();
+IMGUI_IMPL_API void     ImGui_ImplSoft_RenderDrawData(ImDrawData* draw_data, ImU32 clear_col = IM_COL32_BLACK);
+
+// The pixels of the last RenderDrawData(), as ImU32 in IM_COL32() layout (RGBA in memory), valid until the next one.
+IMGUI_IMPL_API const ImU32* ImGui_ImplSoft_GetPixels(int* out_width, int* out_height);
+
+// Called by Init/NewFrame/Shutdown
+IMGUI_IMPL_API bool     ImGui_ImplSoft_CreateFontsTexture();
+IMGUI_IMPL_API void     ImGui_ImplSoft_DestroyFontsTexture();
@@ -1301,6 +1301,191 @@ void ImDrawList::AddNgonFilled(const ImVec2& center, float radius, ImU32 col, in
     PathFillConvex(col);
 }
 
+// Draw the same filled circle (or square) at every centers[i] + offset, for scatter plots of many points.
+// - The marker is tessellated once, around the origin and the same way AddCircleFilled() does it, then copied to each center.
+// - Centers outside of the current clip rectangle (and NaN centers) are skipped before any vertex is written.
+// - All markers share a single PrimReserve() call, or one per 64k vertices with 16-bit indices.
+// - ImDrawMarkerFlags_SquareWhenDense switches to 4-vertex squares when the visible markers would cover more than the clip rectangle.
+// Return the number of markers drawn.
+int ImDrawList::AddMarkers(const ImVec2* centers, int count, const ImVec2& offset, float radius, ImU32 col, ImDrawMarkerFlags flags, int num_segments)
+{
+    if ((col & IM_COL32_A_MASK) == 0 || radius <= 0.0f || count <= 0)
+        return 0;
+
+    // Cull, the visible centers are appended to _Path in screen space (after any path in progress, which is left untouched)
+    const ImVec4& clip = _CmdHeader.ClipRect;
+    const float margin = radius + 1.0f; // + anti-aliasing fringe
+    const ImVec2 cull_min(clip.x - margin - offset.x, clip.y - margin - offset.y);
+    const ImVec2 cull_max(clip.z + margin - offset.x, clip.w + margin - offset.y);
+    const int path_start = _Path.Size;
+    _Path.reserve(path_start + count);
+    ImVec2* visible_centers = _Path.Data + path_start;
+    int visible_count = 0;
+    for (int i = 0; i < count; i++)
+    {
+        const ImVec2& c = centers[i];
+        if (c.x >= cull_min.x && c.x <= cull_max.x && c.y >= cull_min.y && c.y <= cull_max.y)
+            visible_centers[visible_count++] = ImVec2(c.x + offset.x, c.y + offset.y);
+    }
+    if (visible_count == 0)
+        return 0;
+
+    bool square = (flags & ImDrawMarkerFlags_Square) != 0;
+    if (!square && (flags & ImDrawMarkerFlags_SquareWhenDense))
+        square = (float)visible_count * (2.0f * radius) * (2.0f * radius) > (clip.z - clip.x) * (clip.w - clip.y);
+
+    // Build the template: vertices around the origin, indices relative to the first vertex
+    const ImVec2 uv = _Data->TexUvWhitePixel;
+    int vtx_count, idx_count;
+    ImVec2* tmpl_pos;
+    ImDrawVert* tmpl_vtx;
+    ImDrawIdx* tmpl_idx;
+    if (square)
+    {
+        vtx_count = 4;
+        idx_count = 6;
+        tmpl_pos = (ImVec2*)alloca(vtx_count * sizeof(ImVec2)); //-V630
+        tmpl_vtx = (ImDrawVert*)alloca(vtx_count * sizeof(ImDrawVert)); //-V630
+        tmpl_idx = (ImDrawIdx*)alloca(idx_count * sizeof(ImDrawIdx));
+        tmpl_pos[0] = ImVec2(-radius, -radius); tmpl_pos[1] = ImVec2(radius, -radius); tmpl_pos[2] = ImVec2(radius, radius); tmpl_pos[3] = ImVec2(-radius, radius);
+        for (int k = 0; k < vtx_count; k++)
+        {
+            tmpl_vtx[k].uv = uv; tmpl_vtx[k].col = col;
+        }
+        tmpl_idx[0] = 0; tmpl_idx[1] = 1; tmpl_idx[2] = 2; tmpl_idx[3] = 0; tmpl_idx[4] = 2; tmpl_idx[5] = 3;
+    }
+    else
+    {
+        // Obtain segment count, as AddCircleFilled() does
+        if (num_segments <= 0)
+        {
+            const int radius_idx = (int)radius - 1;
+            if (radius_idx < IM_ARRAYSIZE(_Data->CircleSegmentCounts))
+                num_segments = _Data->CircleSegmentCounts[radius_idx];
+            else
+                num_segments = IM_DRAWLIST_CIRCLE_AUTO_SEGMENT_CALC(radius, _Data->CircleSegmentMaxError);
+        }
+        else
+        {
+            num_segments = ImClamp(num_segments, 3, IM_DRAWLIST_CIRCLE_AUTO_SEGMENT_MAX);
+        }
+
+        // Points of the circle, from the precomputed unit circle when it has the right number of segments
+        const int points_count = num_segments;
+        ImVec2* points = (ImVec2*)alloca(points_count * sizeof(ImVec2)); //-V630
+        for (int i = 0; i < points_count; i++)
+        {
+            ImVec2 unit;
+            if (num_segments == 12)
+            {
+                unit = _Data->ArcFastVtx[(i * IM_DRAWLIST_ARCFAST_TESSELLATION_MULTIPLIER) % IM_ARRAYSIZE(_Data->ArcFastVtx)];
+            }
+            else
+            {
+                const float a_max = (IM_PI * 2.0f) * ((float)num_segments - 1.0f) / (float)num_segments;
+                const float a = ((float)i / (float)(num_segments - 1)) * a_max;
+                unit = ImVec2(ImCos(a), ImSin(a));
+            }
+            points[i] = ImVec2(unit.x * radius, unit.y * radius);
+        }
+
+        if (Flags & ImDrawListFlags_AntiAliasedFill)
+        {
+            // Same geometry as the anti-aliased path of AddConvexPolyFilled()
+            const float AA_SIZE = 1.0f;
+            const ImU32 col_trans = col & ~IM_COL32_A_MASK;
+            vtx_count = points_count * 2;
+            idx_count = (points_count - 2) * 3 + points_count * 6;
+            tmpl_pos = (ImVec2*)alloca(vtx_count * sizeof(ImVec2)); //-V630
+            tmpl_vtx = (ImDrawVert*)alloca(vtx_count * sizeof(ImDrawVert)); //-V630
+            tmpl_idx = (ImDrawIdx*)alloca(idx_count * sizeof(ImDrawIdx));
+
+            ImDrawIdx* idx = tmpl_idx;
+            for (int i = 2; i < points_count; i++)
+            {
+                idx[0] = 0; idx[1] = (ImDrawIdx)((i - 1) << 1); idx[2] = (ImDrawIdx)(i << 1);
+                idx += 3;
+            }
+
+            ImVec2* temp_normals = (ImVec2*)alloca(points_count * sizeof(ImVec2)); //-V630
+            for (int i0 = points_count - 1, i1 = 0; i1 < points_count; i0 = i1++)
+            {
+                float dx = points[i1].x - points[i0].x;
+                float dy = points[i1].y - points[i0].y;
+                IM_NORMALIZE2F_OVER_ZERO(dx, dy);
+                temp_normals[i0].x = dy;
+                temp_normals[i0].y = -dx;
+            }
+            for (int i0 = points_count - 1, i1 = 0; i1 < points_count; i0 = i1++)
+            {
+                const ImVec2& n0 = temp_normals[i0];
+                const ImVec2& n1 = temp_normals[i1];
+                float dm_x = (n0.x + n1.x) * 0.5f;
+                float dm_y = (n0.y + n1.y) * 0.5f;
+                IM_FIXNORMAL2F(dm_x, dm_y);
+                dm_x *= AA_SIZE * 0.5f;
+                dm_y *= AA_SIZE * 0.5f;
+
+                tmpl_pos[i1 * 2 + 0] = ImVec2(points[i1].x - dm_x, points[i1].y - dm_y); // Inner
+                tmpl_pos[i1 * 2 + 1] = ImVec2(points[i1].x + dm_x, points[i1].y + dm_y); // Outer
+                tmpl_vtx[i1 * 2 + 0].uv = uv; tmpl_vtx[i1 * 2 + 0].col = col;
+                tmpl_vtx[i1 * 2 + 1].uv = uv; tmpl_vtx[i1 * 2 + 1].col = col_trans;
+
+                idx[0] = (ImDrawIdx)(i1 << 1); idx[1] = (ImDrawIdx)(i0 << 1); idx[2] = (ImDrawIdx)((i0 << 1) + 1);
+                idx[3] = (ImDrawIdx)((i0 << 1) + 1); idx[4] = (ImDrawIdx)((i1 << 1) + 1); idx[5] = (ImDrawIdx)(i1 << 1);
+                idx += 6;
+            }
+        }
+        else
+        {
+            vtx_count = points_count;
+            idx_count = (points_count - 2) * 3;
+            tmpl_pos = points;
+            tmpl_vtx = (ImDrawVert*)alloca(vtx_count * sizeof(ImDrawVert)); //-V630
+            tmpl_idx = (ImDrawIdx*)alloca(idx_count * sizeof(ImDrawIdx));
+            for (int k = 0; k < vtx_count; k++)
+            {
+                tmpl_vtx[k].uv = uv; tmpl_vtx[k].col = col;
+            }
+            for (int i = 2; i < points_count; i++)
+            {
+                tmpl_idx[(i - 2) * 3 + 0] = 0; tmpl_idx[(i - 2) * 3 + 1] = (ImDrawIdx)(i - 1); tmpl_idx[(i - 2) * 3 + 2] = (ImDrawIdx)i;
+            }
+        }
+    }
+
+    // Stamp the template, translating two vertex positions per SIMD add
+    const int markers_per_reserve = (sizeof(ImDrawIdx) == 2) ? ImMax((1 << 16) / vtx_count, 1) : visible_count;
+    for (int first = 0; first < visible_count; first += markers_per_reserve)
+    {
+        const int markers_count = ImMin(markers_per_reserve, visible_count - first);
+        PrimReserve(markers_count * idx_count, markers_count * vtx_count);
+        for (int m = 0; m < markers_count; m++)
+        {
+            const ImVec2 c = visible_centers[first + m];
+            memcpy(_VtxWritePtr, tmpl_vtx, vtx_count * sizeof(ImDrawVert));
+            int k = 0;
+#ifdef IMGUI_ENABLE_SSE
+            const __m128 c2 = _mm_setr_ps(c.x, c.y, c.x, c.y);
+            for (; k + 1 < vtx_count; k += 2)
+            {
+                const __m128 p = _mm_add_ps(_mm_loadu_ps(&tmpl_pos[k].x), c2);
+                _mm_storel_pi((__m64*)&_VtxWritePtr[k].pos, p);
+                _mm_storeh_pi((__m64*)&_VtxWritePtr[k + 1].pos, p);
+            }
+#endif
+            for (; k < vtx_count; k++)
+                _VtxWritePtr[k].pos = ImVec2(tmpl_pos[k].x + c.x, tmpl_pos[k].y + c.y);
+            for (int i = 0; i < idx_count; i++)
+                _IdxWritePtr[i] = (ImDrawIdx)(_VtxCurrentIdx + tmpl_idx[i]);
+            _VtxWritePtr += vtx_count;
+            _IdxWritePtr += idx_count;
+            _VtxCurrentIdx += vtx_count;
+        }
+    }
+    return visible_count;
+}
+
 // Cubic Bezier takes 4 controls points
 void ImDrawList::AddBezierCurve(const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, const ImVec2& p4, ImU32 col, float thickness, int num_segments)
 {
@@ -0,0 +1,88 @@
+// Compares the Vandermonde path of MonomialInterpolation against BarycentricInterpolation.
+//
+// The nodes are Chebyshev points over a canvas sized interval and the values are sampled from a
+// smooth function, so the interpolant itself is well behaved and the error is that of the method.
+
+#include "solve.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+
+const double PI = 3.14159265358979323846;
+const float X_START = 0;
+const float X_END = 1000;
+const int NUM_SAMPLES = 1000;
+
+float target(float x)
+{
+    return 300 + 100 * std::sin(x / 80);
+}
+
+vector<Point> chebyshev_points(int n)
+{
+    vector<Point> points(n);
+    for (int i = 0; i < n; i++) {
+        float t = -std::cos(PI * (i + 0.5) / n);
+        points[i].x = X_START + (t + 1) * 0.5f * (X_END - X_START);
+        points[i].y = target(points[i].x);
+    }
+    return points;
+}
+
+float max_error(const vector<Point>& predicted)
+{
+    float err = 0;
+    for (const auto& p : predicted) {
+        if (std::isnan(p.y)) {
+            return p.y;
+        }
+        err = std::max(err, std::abs(p.y - target(p.x)));
+    }
+    return err;
+}
+
+template <typename F>
+double time_ms(F&& f, int repeat)
+{
+    auto beg = chrono::steady_clock::now();
+    for (int i = 0; i < repeat; i++) {
+        f();
+    }
+    auto end = chrono::steady_clock::now();
+    return chrono::duration<double, milli>(end - beg).count() / repeat;
+}
+
+} // namespace
+
+int main()
+{
+    printf("%6s | %12s %12s %12s | %12s %12s %12s\n", "n", "mono fit", "mono pred", "mono err",
+           "bary fit", "bary pred", "bary err");
+
+    for (int n : {10, 20, 50, 100, 200, 500, 1000, 2000}) {
+        auto points = chebyshev_points(n);
+        int repeat = n <= 100 ? 20 : 1;
+
+        MonomialInterpolation mono;
+        BarycentricInterpolation bary;
+        vector<Point> mono_ys;
+        vector<Point> bary_ys;
+
+        double mono_fit = time_ms([&] { mono = MonomialInterpolation(points); }, repeat);
+        double mono_pred =
+            time_ms([&] { mono_ys = mono.predict(X_START, X_END, NUM_SAMPLES); }, repeat);
+        double bary_fit = time_ms([&] { bary = BarycentricInterpolation(points); }, repeat);
+        double bary_pred =
+            time_ms([&] { bary_ys = bary.predict(X_START, X_END, NUM_SAMPLES); }, repeat);
+
+        printf("%6d | %10.3fms %10.3fms %12.4g | %10.3fms %10.3fms %12.4g\n", n, mono_fit,
+               mono_pred, max_error(mono_ys), bary_fit, bary_pred, max_error(bary_ys));
+    }
+}
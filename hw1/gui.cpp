@@ -1,9 +1,16 @@
 #include "gui.hpp"
+#include "curve_renderer.hpp"
+#include "model.hpp"
+#include "point_file.hpp"
+#include "point_list_box.hpp"
+#include "point_markers.hpp"
+#include "point_set.hpp"
+#include "profiler_window.hpp"
 #include "solve.hpp"
 
 #include <algorithm>
 #include <iostream>
-#include <sstream>
+#include <memory>
 #include <vector>
 
 using namespace std;
@@ -14,127 +21,193 @@ struct Vec2
     float y;
 };
 
+/// The most points the monomial curve interpolates, its Newton form takes quadratic time to build
+constexpr size_t NEWTON_MAX_POINTS = 4096;
+
+/// The most points the dense Gauss fit takes, its kernel matrix is n by n. Beyond it the curve
+/// switches to the CG solve, and the PointSet of the dense fit is no longer kept.
+constexpr size_t GAUSS_DENSE_MAX_POINTS = 4096;
+
 struct GuiData
 {
-    vector<Point> points;
-    string points_str{};
-    int selected{0};
-    vector<char*> points_str_view{};
+    PointList points;
+    uint32_t selected{PointList::NO_ID};
     bool points_changed{false};
     Vec2 scrolling{0.f, 0.f};
     bool opt_enable_grid{true};
     bool opt_enable_context_menu{true};
+    bool opt_adaptive_sampling{false}; // sample the curves by error instead of num_points
+    float sampling_tolerance{0.25f};   // the chord error of adaptive sampling, in pixels
     bool deleting_guard{false};
+    char open_path[260]{}; // of the point file to open
+    string open_error;     // why the last open failed
+    uint64_t points_version{0};                      // bumped on every change of the points
+    shared_ptr<const vector<Point>> points_snapshot; // the points as of points_version
 
     struct
     {
-        int num_points{150}; // control the smoothness of GUI
-        MonomialInterpolation solver;
-        bool enabled{false};  // is this solver enabled
-        bool solve{true};     // should we solve the system
-        bool predict{true};   // should we do the prediction pass
-        vector<Point> points; // cached predicted points
+        NewtonInterpolation newton; // kept in sync with the points incrementally
+        bool synced{true};          // false while newton lags the points, until it is rebuilt
+                                    // for at most NEWTON_MAX_POINTS
+        // newton as of points_version, the fits share it instead of copying the table
+        shared_ptr<const NewtonInterpolation> snapshot{make_shared<const NewtonInterpolation>()};
+        CurveModel curve;
     } monomial;
 
     struct
     {
         float sigma{33};
-        int num_points{150};
-        GaussInterpolation solver;
-        bool enabled{false};
-        bool solve{true};
-        bool predict{true};
-        vector<Point> points;
+        int kernel{0}; // 0 for Gauss, 1 for the compactly supported Wendland, 2 for Gauss by CG
+        IterativeOptions iterative;
+        // kept in step with the points, gives the dense fit its closest pair without a sort
+        PointSet set;
+        bool synced{true}; // false while set lags the points, until it is rebuilt for at most
+                           // GAUSS_DENSE_MAX_POINTS
+        // set as of points_version, null while it is not synced
+        shared_ptr<const PointSet> snapshot;
+        bool truncated{false};     // evaluate with the windowed sum
+        float max_error{0.5f};     // the error bound of the windowed sum, in pixels
+        bool check_error{false};   // the next prediction also runs the exact sum, for the error
+        bool error_checked{false}; // the shown curve was predicted with check_error
+        float solved_sigma{-1};    // the sigma of the current fit
+        CurveModel curve;
     } gauss;
 
     struct
     {
         int m{3};
-        int num_points{150};
-        LeastSquare solver;
-        bool enabled{false};
-        bool solve{true};
-        bool predict{true};
-        vector<Point> points;
+        int solved_m{-1}; // the order last requested from the solver
+        CurveModel curve; // an OrthogonalLeastSquare, keeps the lower orders on an order change
     } least_square;
 
     struct
     {
         int m{3};
         float a{0.01};
-        int num_points{150};
-        RidgeRegression solver;
-        bool enabled{false};
-        bool solve{true};
-        bool predict{true};
-        vector<Point> points;
+        int solved_m{-1};
+        float solved_a{-1};
+        CurveModel curve; // a RidgeCurve, the SVD is recomputed only for new points or a new order
     } ridge_regression;
 };
 
 GuiData gui_data{};
+ThreadPool thread_pool{};
+CurveRenderer curve_renderer{};
 
-void GuiOnPointsChanged()
+void DrawCurve(ImDrawList* draw_list, const ImVec2& origin, const vector<Point>& xy, ImU32 color)
 {
-    if (!gui_data.points_changed)
-        return;
-
-    gui_data.points_str.clear();
-    gui_data.points_str_view.clear();
-
-    if (gui_data.points.size() == 0)
-        return;
+    curve_renderer.draw(draw_list, origin, xy, color);
+}
 
-    ostringstream oss{};
-    auto beg = oss.tellp();
+/// Removes the point at index i and selects the one that takes its place
+void RemovePoint(size_t i)
+{
+    auto& points = gui_data.points;
+    auto& mi = gui_data.monomial;
+    if (mi.synced && i + 1 == points.size()) {
+        mi.newton.remove_point(static_cast<int>(i));
+    }
+    else {
+        // the last point moves into the gap, newton is rebuilt in the new order
+        mi.newton.clear();
+        mi.synced = false;
+    }
+    if (gui_data.gauss.synced)
+        gui_data.gauss.set.erase(i);
+    points.remove(i);
+    if (!points.empty())
+        gui_data.selected = points.id(std::min(i, points.size() - 1));
+    gui_data.points_changed = true;
+}
 
-    gui_data.points_str_view.reserve(gui_data.points.size());
-    for (const auto& p : gui_data.points) {
-        gui_data.points_str_view.push_back(reinterpret_cast<char*>(oss.tellp() - beg));
-        oss << "x: " << p.x << ", "
-            << "y:" << p.y;
-        oss.put(0);
+JobState GuiJobs()
+{
+    JobState state;
+    for (const CurveModel* model : {&gui_data.monomial.curve, &gui_data.gauss.curve,
+                                    &gui_data.least_square.curve,
+                                    &gui_data.ridge_regression.curve}) {
+        state.busy = state.busy || model->busy();
+        state.published += model->published();
     }
-    gui_data.points_str = oss.str();
+    return state;
+}
 
-    for (auto& ptr : gui_data.points_str_view) {
-        ptr = gui_data.points_str.data() + reinterpret_cast<ptrdiff_t>(ptr);
+bool OpenPointFile(const string& path, string& error)
+{
+    MappedPointFile file;
+    if (!file.open(path, error)) {
+        return false;
     }
+    vector<Point> points;
+    file.copy_to(points);
+    gui_data.points.assign(std::move(points));
+    gui_data.selected = PointList::NO_ID;
+    gui_data.points_changed = true;
+    gui_data.monomial.newton.clear();
+    gui_data.monomial.synced = false;
+    gui_data.gauss.set.clear();
+    gui_data.gauss.synced = false;
+    error.clear();
+    return true;
 }
 
 void DrawImGUI()
 {
-    ImGui_ImplOpenGL3_NewFrame();
-    ImGui_ImplGlfw_NewFrame();
+    PROFILE_SCOPE("DrawImGUI");
     ImGui::NewFrame();
 
     if (ImGui::IsKeyReleased(ImGui::GetKeyIndex(ImGuiKey_Delete))) {
         gui_data.deleting_guard = false;
     }
 
-    if (gui_data.selected >= gui_data.points.size()) {
-        gui_data.selected = gui_data.points.size() - 1;
+    if (gui_data.points.index(gui_data.selected) == PointList::NONE && !gui_data.points.empty()) {
+        gui_data.selected = gui_data.points.id(0);
     }
 
-    if (!gui_data.deleting_guard && gui_data.points.size() > 0 &&
+    const size_t selected = gui_data.points.index(gui_data.selected);
+    if (!gui_data.deleting_guard && selected != PointList::NONE &&
         ImGui::IsKeyPressed(ImGui::GetKeyIndex(ImGuiKey_Delete))) {
-        gui_data.points.erase(gui_data.points.begin() + gui_data.selected);
-        gui_data.points_changed = true;
+        RemovePoint(selected);
         gui_data.deleting_guard = true;
     }
 
     if (gui_data.points_changed) {
-        GuiOnPointsChanged();
-        gui_data.monomial.solve = true;
-        gui_data.gauss.solve = true;
-        gui_data.least_square.solve = true;
-        gui_data.ridge_regression.solve = true;
+        auto& mi = gui_data.monomial;
+        if (!mi.synced && gui_data.points.size() <= NEWTON_MAX_POINTS) {
+            mi.newton = NewtonInterpolation(gui_data.points.points());
+            mi.synced = true;
+        }
+        mi.snapshot = make_shared<const NewtonInterpolation>(mi.newton);
+        auto& gs = gui_data.gauss;
+        if (gui_data.points.size() > GAUSS_DENSE_MAX_POINTS) {
+            gs.set.clear();
+            gs.synced = false;
+        }
+        else if (!gs.synced) {
+            gs.set = PointSet(gui_data.points.begin(), gui_data.points.end());
+            gs.synced = true;
+        }
+        gs.snapshot = gs.synced ? make_shared<const PointSet>(gs.set) : nullptr;
+        gui_data.monomial.curve.solve = true;
+        gui_data.gauss.curve.solve = true;
+        gui_data.least_square.curve.solve = true;
+        gui_data.ridge_regression.curve.solve = true;
+        gui_data.points_version++;
+        gui_data.points_snapshot = gui_data.points.snapshot();
         gui_data.points_changed = false;
     }
 
     if (ImGui::Begin("Points")) {
-        ImGui::ListBox("##1", &gui_data.selected, gui_data.points_str_view.data(),
-                       gui_data.points_str_view.size(),
-                       std::min<int>(30, gui_data.points_str_view.size()));
+        ImGui::InputText("##path", gui_data.open_path, sizeof(gui_data.open_path));
+        ImGui::SameLine();
+        if (ImGui::Button("Open")) {
+            OpenPointFile(gui_data.open_path, gui_data.open_error);
+        }
+        if (!gui_data.open_error.empty()) {
+            ImGui::TextColored({1.f, 0.4f, 0.4f, 1.f}, "%s", gui_data.open_error.c_str());
+        }
+        PROFILE_SCOPE("PointListBox");
+        PointListBox("##1", gui_data.points, gui_data.selected);
     }
     ImGui::End();
 
@@ -145,101 +218,166 @@ void DrawImGUI()
         ImGui::PushItemWidth(100);
 
         ImGui::BeginGroup();
-        ImGui::Checkbox("Enable Monomial Interpolation", &gui_data.monomial.enabled);
+        ImGui::Checkbox("Adaptive sampling", &gui_data.opt_adaptive_sampling);
+        if (gui_data.opt_adaptive_sampling) {
+            ImGui::SameLine();
+            ImGui::InputFloat("Tolerance (px)", &gui_data.sampling_tolerance, 0.05, 0.5);
+        }
+        int evaluations = 0;
+        for (auto* curve : {&gui_data.monomial.curve, &gui_data.gauss.curve,
+                            &gui_data.least_square.curve, &gui_data.ridge_regression.curve}) {
+            if (curve->enabled)
+                evaluations += curve->result()->evaluations;
+        }
+        ImGui::SameLine();
+        ImGui::Text("%d evaluations", evaluations);
+        ImGui::EndGroup();
+
+        ImGui::BeginGroup();
+        ImGui::Checkbox("Enable Monomial Interpolation", &gui_data.monomial.curve.enabled);
         ImGui::SameLine();
-        ImGui::InputInt("Points##1", &gui_data.monomial.num_points, 1, 10);
+        ImGui::InputInt("Points##1", &gui_data.monomial.curve.num_points, 1, 10);
         ImGui::EndGroup();
 
         ImGui::BeginGroup();
-        ImGui::Checkbox("Enable Gauss Interpolation   ", &gui_data.gauss.enabled);
+        ImGui::Checkbox("Enable Gauss Interpolation   ", &gui_data.gauss.curve.enabled);
         ImGui::SameLine();
-        ImGui::InputInt("Points##2", &gui_data.gauss.num_points, 1, 10);
+        ImGui::InputInt("Points##2", &gui_data.gauss.curve.num_points, 1, 10);
         ImGui::SameLine();
         ImGui::InputFloat("Weight##4", &gui_data.gauss.sigma, 0.5, 5.0);
+        ImGui::SameLine();
+        if (ImGui::Combo("Kernel##2", &gui_data.gauss.kernel, "Gauss\0Wendland\0Gauss (CG)\0")) {
+            gui_data.gauss.curve.solve = true;
+        }
+        if (gui_data.gauss.kernel != 1) {
+            ImGui::SameLine();
+            if (ImGui::Checkbox("Windowed##2", &gui_data.gauss.truncated)) {
+                gui_data.gauss.curve.predict = true;
+            }
+            if (gui_data.gauss.truncated) {
+                ImGui::SameLine();
+                if (ImGui::InputFloat("Max error##2", &gui_data.gauss.max_error, 0.1, 1.0)) {
+                    gui_data.gauss.curve.predict = true;
+                }
+                ImGui::SameLine();
+                if (ImGui::Button("Check##2")) {
+                    gui_data.gauss.check_error = true;
+                    gui_data.gauss.curve.predict = true;
+                }
+                if (gui_data.gauss.error_checked) {
+                    ImGui::SameLine();
+                    ImGui::Text("error %.3g", gui_data.gauss.curve.result()->error);
+                }
+            }
+        }
+        auto gauss_result = gui_data.gauss.curve.result();
+        auto cg = get_if<GaussInterpolation>(&gauss_result->solver);
+        if (cg && gui_data.gauss.kernel == 2) {
+            ImGui::SameLine();
+            ImGui::Text("CG: %d iterations, residual %.2g", cg->iterations, cg->residual);
+        }
+        if (gui_data.points.size() > GAUSS_DENSE_MAX_POINTS) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("(the dense Gauss kernel takes up to %zu points)",
+                                GAUSS_DENSE_MAX_POINTS);
+        }
         ImGui::EndGroup();
 
         ImGui::BeginGroup();
-        ImGui::Checkbox("Enable Least Square          ", &gui_data.least_square.enabled);
+        ImGui::Checkbox("Enable Least Square          ", &gui_data.least_square.curve.enabled);
         ImGui::SameLine();
-        ImGui::InputInt("Points##3", &gui_data.least_square.num_points, 1, 10);
+        ImGui::InputInt("Points##3", &gui_data.least_square.curve.num_points, 1, 10);
         ImGui::SameLine();
         ImGui::InputInt("Order##3", &gui_data.least_square.m, 1, 1);
+        ImGui::SameLine();
+        auto ls_result = gui_data.least_square.curve.result();
+        auto ols = get_if<OrthogonalLeastSquare>(&ls_result->solver);
+        if (ImGui::Button("LOOCV##3") && ols) {
+            // the published solver is shared with the workers, the higher orders go to a copy
+            gui_data.least_square.m = OrthogonalLeastSquare{*ols}.best_order(15);
+        }
         ImGui::EndGroup();
 
         ImGui::BeginGroup();
-        ImGui::Checkbox("Enable Ridge Regression      ", &gui_data.ridge_regression.enabled);
+        ImGui::Checkbox("Enable Ridge Regression      ", &gui_data.ridge_regression.curve.enabled);
         ImGui::SameLine();
-        ImGui::InputInt("Points##4", &gui_data.ridge_regression.num_points, 1, 10);
+        ImGui::InputInt("Points##4", &gui_data.ridge_regression.curve.num_points, 1, 10);
         ImGui::SameLine();
         ImGui::InputInt("Order##4", &gui_data.ridge_regression.m, 1, 1);
         ImGui::SameLine();
         ImGui::InputFloat("Weight##4", &gui_data.ridge_regression.a, 0.001, 0.01);
+        ImGui::SameLine();
+        auto rr_result = gui_data.ridge_regression.curve.result();
+        auto rc = get_if<RidgeCurve>(&rr_result->solver);
+        if (ImGui::Button("GCV##4") && rc && rc->path.n > 0) {
+            gui_data.ridge_regression.a = rc->path.select_gcv(0.001f, 1.0f);
+        }
         ImGui::EndGroup();
 
+        // as of the last frame, the curves of this one are drawn below
+        const auto& drawn = curve_renderer.draw_stats();
+        ImGui::Text("Curves: %d of %d points drawn, %d vertices, %d indices in %.3f ms",
+                    drawn.drawn_points, drawn.input_points, drawn.vertices, drawn.indices,
+                    drawn.build_ms);
+        for (auto [name, curve] : {pair{"Monomial", &gui_data.monomial.curve},
+                                   pair{"Gauss", &gui_data.gauss.curve},
+                                   pair{"Least Square", &gui_data.least_square.curve},
+                                   pair{"Ridge Regression", &gui_data.ridge_regression.curve}}) {
+            auto error = curve->enabled ? curve->error() : string();
+            if (!error.empty()) {
+                ImGui::TextColored({1.f, 0.4f, 0.4f, 1.f}, "%s failed: %s", name, error.c_str());
+            }
+        }
+
         ImGui::Text("Mouse Right: drag to scroll, click for context menu.");
 
-        if (gui_data.monomial.enabled) {
-            auto& mi = gui_data.monomial;
+        if (gui_data.sampling_tolerance < 0.01f)
+            gui_data.sampling_tolerance = 0.01f;
 
-            if (mi.num_points < 2)
-                mi.num_points = 2;
+        for (auto* curve : {&gui_data.monomial.curve, &gui_data.gauss.curve,
+                            &gui_data.least_square.curve, &gui_data.ridge_regression.curve}) {
+            curve->adaptive = gui_data.opt_adaptive_sampling;
+            curve->adaptive_opts.tolerance = gui_data.sampling_tolerance;
+        }
 
-            if (mi.num_points != mi.points.size())
-                mi.predict = true;
+        if (gui_data.monomial.curve.enabled) {
+            auto& mi = gui_data.monomial.curve;
 
-            if (mi.solve) {
-                mi.solver = MonomialInterpolation(gui_data.points);
-                mi.solve = false;
-                mi.predict = true;
-            }
+            if (mi.num_points < 2)
+                mi.num_points = 2;
         }
 
-        if (gui_data.gauss.enabled) {
+        if (gui_data.gauss.curve.enabled) {
             auto& gs = gui_data.gauss;
             if (gs.sigma < 10)
                 gs.sigma = 10;
             if (gs.sigma > 100)
                 gs.sigma = 100;
 
-            if (gs.num_points < 2)
-                gs.num_points = 2;
+            if (gs.curve.num_points < 2)
+                gs.curve.num_points = 2;
 
-            if (gs.sigma != gs.solver.sigma)
-                gs.solve = true;
+            if (gs.max_error < 1e-3f)
+                gs.max_error = 1e-3f;
 
-            if (gs.num_points != gs.points.size())
-                gs.predict = true;
-
-            if (gs.solve) {
-                gs.solver = GaussInterpolation(gs.sigma, gui_data.points);
-                gs.solve = false;
-                gs.predict = true;
-            }
+            if (gs.sigma != gs.solved_sigma)
+                gs.curve.solve = true;
         }
 
-        if (gui_data.least_square.enabled) {
+        if (gui_data.least_square.curve.enabled) {
             auto& ls = gui_data.least_square;
             if (ls.m < 0)
                 ls.m = 0;
             if (ls.m > 15)
                 ls.m = 15;
-            if (ls.num_points < 2)
-                ls.num_points = 2;
-
-            if (ls.m != ls.solver.m)
-                ls.solve = true;
+            if (ls.curve.num_points < 2)
+                ls.curve.num_points = 2;
 
-            if (ls.num_points != ls.points.size())
-                ls.predict = true;
-
-            if (ls.solve) {
-                ls.solver = LeastSquare(ls.m, gui_data.points);
-                ls.solve = false;
-                ls.predict = true;
-            }
+            if (ls.m != ls.solved_m)
+                ls.curve.solve = true;
         }
 
-        if (gui_data.ridge_regression.enabled) {
+        if (gui_data.ridge_regression.curve.enabled) {
             auto& rr = gui_data.ridge_regression;
             if (rr.m < 0)
                 rr.m = 0;
@@ -251,27 +389,11 @@ void DrawImGUI()
             if (rr.a > 1)
                 rr.a = 1;
 
-            if (rr.num_points < 2)
-                rr.num_points = 2;
-
-            if (rr.m != rr.solver.m) {
-                rr.solve = true;
-                rr.predict = true;
-            }
-
-            if (rr.a != rr.solver.a) {
-                rr.solve = true;
-                rr.predict = true;
-            }
-
-            if (rr.num_points != rr.points.size())
-                rr.predict = true;
+            if (rr.curve.num_points < 2)
+                rr.curve.num_points = 2;
 
-            if (rr.solve) {
-                rr.solver = RidgeRegression(rr.m, rr.a, gui_data.points);
-                rr.solve = false;
-                rr.predict = true;
-            }
+            if (rr.m != rr.solved_m || rr.a != rr.solved_a)
+                rr.curve.solve = true;
         }
 
         // Using InvisibleButton() as a convenience 1) it will advance the layout cursor and 2)
@@ -300,7 +422,11 @@ void DrawImGUI()
 
         // Add first and second point
         if (is_hovered && ImGui::IsMouseClicked(ImGuiMouseButton_Left)) {
-            gui_data.points.push_back(mouse_pos_in_canvas);
+            gui_data.points.add(mouse_pos_in_canvas);
+            if (gui_data.monomial.synced)
+                gui_data.monomial.newton.add_point(mouse_pos_in_canvas);
+            if (gui_data.gauss.synced)
+                gui_data.gauss.set.push_back(mouse_pos_in_canvas.x, mouse_pos_in_canvas.y);
             gui_data.points_changed = true;
         }
 
@@ -321,12 +447,112 @@ void DrawImGUI()
         if (ImGui::BeginPopup("context")) {
             if (ImGui::MenuItem("Remove all", NULL, false, gui_data.points.size() > 0)) {
                 gui_data.points.clear();
+                gui_data.monomial.newton.clear();
+                gui_data.monomial.synced = true;
+                gui_data.gauss.set.clear();
+                gui_data.gauss.synced = true;
                 gui_data.points_changed = true;
             }
             ImGui::EndPopup();
         }
 
+        // Every enabled curve is fitted and predicted in the background, on snapshots of the points
+        // and parameters, and drawn from its last complete result in the meantime. Frames never
+        // wait for a solver. Only the visible part of the canvas is predicted.
+        auto points = gui_data.points_snapshot;
+        if (!points)
+            points = make_shared<const vector<Point>>();
+        const auto version = gui_data.points_version;
+        const float view_x0 = -gui_data.scrolling.x;
+        const float view_x1 = view_x0 + canvas_sz.x;
+
+        if (gui_data.monomial.curve.enabled) {
+            auto& mi = gui_data.monomial;
+            mi.curve.dispatch(
+                thread_pool, version,
+                [newton = mi.snapshot](CurveSolver& s, bool, const Cancelled&) {
+                    s = NewtonCurve{newton};
+                },
+                view_x0, view_x1);
+        }
+
+        if (gui_data.gauss.curve.enabled) {
+            auto& gs = gui_data.gauss;
+            if (gs.kernel == 0 && points->size() > GAUSS_DENSE_MAX_POINTS) {
+                // the n by n kernel matrix would not fit, the CG solve reaches the same curve
+                gs.kernel = 2;
+                gs.curve.solve = true;
+            }
+            gs.solved_sigma = gs.sigma;
+            auto fit = [points, set = gs.snapshot, kernel = gs.kernel, sigma = gs.sigma,
+                        iterative = gs.iterative](CurveSolver& s, bool, const Cancelled&) {
+                if (kernel == 0 && set)
+                    s = GaussInterpolation(sigma, *set);
+                else if (kernel == 0)
+                    s = GaussInterpolation(sigma, *points);
+                else if (kernel == 1)
+                    s = WendlandInterpolation(sigma, *points);
+                else
+                    s = GaussInterpolation(sigma, *points, iterative);
+            };
+            CurveModel::Predict windowed = nullptr;
+            if (gs.kernel != 1 && gs.truncated) {
+                // the exact sum costs as much as not windowing, so it only runs when asked for
+                windowed = [max_error = gs.max_error, check = gs.check_error](
+                               CurveResult& r, float x_start, float x_end, int num_points) {
+                    if (auto g = get_if<GaussInterpolation>(&r.solver))
+                        r.points = g->predict_truncated(x_start, x_end, num_points, max_error,
+                                                        check ? &r.error : nullptr);
+                };
+            }
+            if (gs.curve.solve || gs.curve.predict) {
+                // a new fit or prediction makes the tiles stale, and a measured error with them
+                gs.error_checked = gs.check_error;
+            }
+            gs.check_error = false;
+            gs.curve.dispatch(thread_pool, version, fit, view_x0, view_x1, windowed);
+        }
+
+        if (gui_data.least_square.curve.enabled) {
+            auto& ls = gui_data.least_square;
+            ls.curve.dispatch(
+                thread_pool, version,
+                [points, m = ls.m](CurveSolver& s, bool same_data, const Cancelled&) {
+                    // an order change only fits the orders not fitted yet
+                    auto ols = get_if<OrthogonalLeastSquare>(&s);
+                    if (same_data && ols)
+                        ols->set_order(m);
+                    else
+                        s = OrthogonalLeastSquare(m, *points);
+                },
+                view_x0, view_x1);
+            ls.solved_m = ls.m;
+        }
+
+        if (gui_data.ridge_regression.curve.enabled) {
+            auto& rr = gui_data.ridge_regression;
+            rr.curve.dispatch(
+                thread_pool, version,
+                [points, m = rr.m, a = rr.a](CurveSolver& s, bool same_data, const Cancelled&) {
+                    // a new weight only needs a solve from the cached path
+                    auto rc = get_if<RidgeCurve>(&s);
+                    if (!same_data || !rc || rc->path.m != m) {
+                        RidgeRegressionPath path(m, *points);
+                        RidgeRegression solver = path.solve(a);
+                        s = RidgeCurve{std::move(path), std::move(solver)};
+                    }
+                    else {
+                        rc->solver = rc->path.solve(a);
+                    }
+                },
+                view_x0, view_x1);
+            rr.solved_m = rr.m;
+            rr.solved_a = rr.a;
+        }
+
         // Draw grid + all lines in the canvas
+        PROFILE_SCOPE("ImDrawList");
+        curve_renderer.reset_stats();
         draw_list->PushClipRect(canvas_p0, canvas_p1, true);
         if (gui_data.opt_enable_grid) {
             const float GRID_STEP = 64.0f;
@@ -338,79 +564,37 @@ void DrawImGUI()
                                    IM_COL32(200, 200, 200, 40));
         }
 
-        if (gui_data.points.size()) {
-            draw_list->AddCircleFilled(
-                {origin.x + gui_data.points[0].x, origin.y + gui_data.points[0].y}, 4,
-                IM_COL32(255, 100, 100, 255));
-        }
+        const auto& marked = gui_data.points.points();
+        const ImU32 point_color = IM_COL32(255, 100, 100, 255);
+        draw_point_markers(draw_list, origin, marked, 0, 1, 4, point_color);
 
-        if (gui_data.monomial.enabled && gui_data.monomial.solver.m > 0) {
-            auto& mi = gui_data.monomial;
-            if (mi.predict) {
-                mi.points = mi.solver.predict(0, canvas_sz.x, mi.num_points);
-                mi.predict = false;
-            }
-            const auto& xy = mi.points;
-            for (int n = 1; n < xy.size(); n++) {
-                draw_list->AddLine({origin.x + xy[n - 1].x, origin.y + xy[n - 1].y},
-                                   {origin.x + xy[n].x, origin.y + xy[n].y},
-                                   IM_COL32(128, 255, 255, 255), 2.0f);
-            }
+        if (gui_data.monomial.curve.enabled && gui_data.monomial.newton.m > 0) {
+            DrawCurve(draw_list, origin, gui_data.monomial.curve.result()->points,
+                      IM_COL32(128, 255, 255, 255));
         }
 
-        if (gui_data.gauss.enabled && gui_data.gauss.solver.m > 0) {
-            auto& gs = gui_data.gauss;
-            if (gs.predict) {
-                gs.points = gs.solver.predict(0, canvas_sz.x, gs.num_points);
-                gs.predict = false;
-            }
-            const auto& xy = gs.points;
-            for (int n = 1; n < xy.size(); n++) {
-                draw_list->AddLine({origin.x + xy[n - 1].x, origin.y + xy[n - 1].y},
-                                   {origin.x + xy[n].x, origin.y + xy[n].y},
-                                   IM_COL32(255, 128, 255, 255), 2.0f);
-            }
+        if (gui_data.gauss.curve.enabled && gui_data.points.size() > 0) {
+            DrawCurve(draw_list, origin, gui_data.gauss.curve.result()->points,
+                      IM_COL32(255, 128, 255, 255));
         }
 
-        if (gui_data.least_square.enabled) {
-            auto& ll = gui_data.least_square;
-            if (ll.predict) {
-                ll.points = ll.solver.predict(0, canvas_sz.x, ll.num_points);
-                ll.predict = false;
-            }
-            const auto& xy = ll.points;
-            for (int n = 1; n < xy.size(); n++) {
-                draw_list->AddLine({origin.x + xy[n - 1].x, origin.y + xy[n - 1].y},
-                                   {origin.x + xy[n].x, origin.y + xy[n].y},
-                                   IM_COL32(255, 255, 128, 255), 2.0f);
-            }
+        if (gui_data.least_square.curve.enabled) {
+            DrawCurve(draw_list, origin, gui_data.least_square.curve.result()->points,
+                      IM_COL32(255, 255, 128, 255));
         }
 
-        if (gui_data.ridge_regression.enabled) {
-            auto& rr = gui_data.ridge_regression;
-            if (rr.predict) {
-                rr.points = rr.solver.predict(0, canvas_sz.x, rr.num_points);
-                rr.predict = false;
-            }
-            const auto& xy = rr.points;
-            for (int n = 1; n < xy.size(); n++) {
-                draw_list->AddLine({origin.x + xy[n - 1].x, origin.y + xy[n - 1].y},
-                                   {origin.x + xy[n].x, origin.y + xy[n].y},
-                                   IM_COL32(0, 255, 255, 255), 2.0f);
-            }
+        if (gui_data.ridge_regression.curve.enabled) {
+            DrawCurve(draw_list, origin, gui_data.ridge_regression.curve.result()->points,
+                      IM_COL32(0, 255, 255, 255));
         }
 
-        for (int n = 1; n < gui_data.points.size(); n++) {
-            draw_list->AddCircleFilled(
-                {origin.x + gui_data.points[n].x, origin.y + gui_data.points[n].y}, 5,
-                IM_COL32(255, 100, 100, 255));
-        }
+        draw_point_markers(draw_list, origin, marked, 1, marked.size(), 5, point_color);
         draw_list->PopClipRect();
     }
 
     ImGui::End();
 
-    ImGui::Render();
+    DrawProfilerWindow();
 
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    ImGui::Render();
 }
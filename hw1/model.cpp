@@ -0,0 +1,181 @@
+#include "model.hpp"
+
+#include <type_traits>
+
+using namespace std;
+
+namespace
+{
+
+template <typename S, typename = void>
+struct has_buffered_predict : false_type
+{
+};
+
+template <typename S>
+struct has_buffered_predict<S, void_t<decltype(declval<S&>().predict(0.f, 0.f, 0,
+                                                                     declval<Point*>()))>>
+    : true_type
+{
+};
+
+} // namespace
+
+float NewtonCurve::evaluate(float x) const
+{
+    return newton->evaluate(x);
+}
+
+vector<Point> NewtonCurve::predict(float x_start, float x_end, int num_points) const
+{
+    return newton->predict(x_start, x_end, num_points);
+}
+
+float RidgeCurve::evaluate(float x) const
+{
+    return solver.evaluate(x);
+}
+
+void RidgeCurve::predict(float x_start, float x_end, int num_points, Point* out)
+{
+    solver.predict(x_start, x_end, num_points, out);
+}
+
+void predict_curve(CurveSolver& solver, float x_start, float x_end, int num_points,
+                   vector<Point>& out)
+{
+    visit(
+        [&](auto& s) {
+            using S = decay_t<decltype(s)>;
+            if constexpr (is_same_v<S, monostate>) {
+                out.clear();
+            }
+            else if constexpr (has_buffered_predict<S>::value) {
+                // reuses the capacity of the previous curve
+                out.resize(num_points);
+                s.predict(x_start, x_end, num_points, out.data());
+            }
+            else {
+                out = s.predict(x_start, x_end, num_points);
+            }
+        },
+        solver);
+}
+
+int sample_curve(CurveSolver& solver, float x_start, float x_end, const AdaptiveOptions& opts,
+                 vector<Point>& out)
+{
+    return visit(
+        [&](auto& s) {
+            using S = decay_t<decltype(s)>;
+            if constexpr (is_same_v<S, monostate>) {
+                out.clear();
+                return 0;
+            }
+            else {
+                return sample_adaptive([&s](float x) { return s.evaluate(x); }, x_start, x_end,
+                                       opts, out);
+            }
+        },
+        solver);
+}
+
+void CurveModel::dispatch(ThreadPool& pool, uint64_t data_version, const Fit& fit, float x_start,
+                          float x_end, const Predict& predict)
+{
+    float tolerance = adaptive ? adaptive_opts.tolerance : -1;
+    if (tolerance != predicted_tolerance)
+        this->predict = true;
+
+    // Only a new fit or a new way of sampling make the cached tiles stale. A new range or
+    // num_points just picks other tiles.
+    bool stale = solve || this->predict;
+    if (!stale && num_points == predicted_points && x_start == predicted_x_start &&
+        x_end == predicted_x_end)
+        return;
+
+    if (solve && fit) {
+        last_fit = fit;
+        last_data_version = data_version;
+    }
+    // the job below cancels a fit still in flight, which then has to be redone, and likewise a
+    // job that would have made the tiles stale
+    bool do_fit = (solve && fit) || (last_fit && async.published() < last_fit_version);
+    stale = stale || async.published() < last_stale_version;
+
+    solve = false;
+    this->predict = false;
+    predicted_points = num_points;
+    predicted_tolerance = tolerance;
+    predicted_x_start = x_start;
+    predicted_x_end = x_end;
+
+    auto job = [=, fit = last_fit, data_version = last_data_version, num_points = num_points,
+                adaptive = adaptive,
+                opts = adaptive_opts](CurveResult& r, const Cancelled& cancelled) {
+        if (do_fit) {
+            fit(r.solver, r.data_version == data_version, cancelled);
+            r.data_version = data_version;
+            if (cancelled())
+                return false;
+        }
+        if (stale) {
+            r.model_version++;
+            r.error = 0;
+        }
+
+        // in a tile the adaptive sampling starts from one segment per 8 sample spacings
+        AdaptiveOptions tile_opts = opts;
+        tile_opts.initial_segments = TILE_SAMPLES / 8;
+
+        r.evaluations = 0;
+        auto predict_tile = [&](float x0, float x1, int n, vector<Point>& tile) {
+            if (predict) {
+                float error = r.error;
+                predict(r, x0, x1, n);
+                r.error = max(error, r.error);
+                tile = move(r.points);
+                r.evaluations += static_cast<int>(tile.size());
+            }
+            else if (adaptive) {
+                r.evaluations += sample_curve(r.solver, x0, x1, tile_opts, tile);
+            }
+            else {
+                predict_curve(r.solver, x0, x1, n, tile);
+                r.evaluations += static_cast<int>(tile.size());
+            }
+        };
+
+        vector<Point> points;
+        int level = tile_level(x_end - x_start, num_points);
+        r.predicted_tiles = predict_tiled(r.tiles, r.model_version, level, x_start, x_end,
+                                          predict_tile, points);
+        r.points = move(points);
+        return true;
+    };
+    auto version = async.submit(pool, job);
+    if (do_fit)
+        last_fit_version = version;
+    if (stale)
+        last_stale_version = version;
+}
+
+shared_ptr<const CurveResult> CurveModel::result() const
+{
+    return async.get();
+}
+
+bool CurveModel::busy() const
+{
+    return async.busy();
+}
+
+uint64_t CurveModel::published() const
+{
+    return async.published();
+}
+
+string CurveModel::error() const
+{
+    return async.error();
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "solve.hpp"
+#include "adaptive_sampling.hpp"
+#include "async_result.hpp"
+#include "thread_pool.hpp"
+#include "tile_cache.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+/// A ridge regression together with the cached path it was solved from, so that a new weight does
+/// not need a new SVD
+struct RidgeCurve
+{
+    RidgeRegressionPath path;
+    RidgeRegression solver;
+    float evaluate(float x) const;
+    void predict(float x_start, float x_end, int num_points, Point* out);
+};
+
+/// A Newton interpolation shared with the GUI, which keeps the table in sync with the points, so
+/// that a fit only copies the pointer
+struct NewtonCurve
+{
+    std::shared_ptr<const NewtonInterpolation> newton;
+    float evaluate(float x) const;
+    std::vector<Point> predict(float x_start, float x_end, int num_points) const;
+};
+
+/// Every solver a curve on the canvas can be drawn with, monostate until the first fit
+using CurveSolver = std::variant<std::monostate, NewtonCurve, GaussInterpolation,
+                                 WendlandInterpolation, OrthogonalLeastSquare, RidgeCurve>;
+
+struct CurveResult
+{
+    CurveSolver solver;
+    std::vector<Point> points; // the predicted points
+    float error{0};            // deviation reported by a custom prediction
+    int evaluations{0};        // evaluations of the solver the prediction took
+    uint64_t data_version{0};  // version of the point set the solver was fitted to
+    uint64_t model_version{0}; // bumped by every fit or change of the sampling
+    int predicted_tiles{0};    // tiles the prediction did not find in the cache
+    TileCache<std::vector<Point>> tiles;
+};
+
+/// One curve of the canvas. Its fit and predict run in the background on a ThreadPool, a newer
+/// dispatch() cancels the one in flight, and result() keeps returning the last complete curve
+/// until the new one is ready. The prediction is assembled from tiles cached by model version,
+/// so panning only predicts the tiles that come into view.
+struct CurveModel
+{
+    /// same_data is true if solver was fitted to the same point set before and may be updated
+    /// incrementally
+    using Fit =
+        std::function<void(CurveSolver& solver, bool same_data, const Cancelled& cancelled)>;
+    using Predict = std::function<void(CurveResult& result, float x_start, float x_end,
+                                       int num_points)>;
+
+    int num_points{150};  // control the smoothness of GUI
+    bool enabled{false};  // is this solver enabled
+    bool solve{true};     // should we solve the system
+    bool predict{true};   // should we do the prediction pass
+    bool adaptive{false}; // sample by sample_adaptive instead of num_points uniform samples
+    AdaptiveOptions adaptive_opts;
+
+    /// Queues fit (if solve is set) and the prediction of [x_start, x_end] on the pool and clears
+    /// both flags. The prediction is redone as well when the sampling or the range changed since
+    /// the last dispatch, and a fit that has been cancelled before it was published is run again.
+    /// Without a predict callback the solver's own predict is used, or sample_curve if adaptive
+    /// is set. num_points is the density over the range, rounded up to a power of two spacing.
+    void dispatch(ThreadPool& pool, uint64_t data_version, const Fit& fit, float x_start,
+                  float x_end, const Predict& predict = nullptr);
+
+    std::shared_ptr<const CurveResult> result() const;
+
+    bool busy() const;
+
+    /// the version of the job that published result(), see AsyncResult::published()
+    uint64_t published() const;
+
+    /// why the last fit or prediction failed, empty if it did not
+    std::string error() const;
+
+private:
+    AsyncResult<CurveResult> async;
+    Fit last_fit;                   // the fit of the last dispatch that had one
+    uint64_t last_data_version{0};  // and its arguments
+    uint64_t last_fit_version{0};   // and the version of its job
+    uint64_t last_stale_version{0}; // the last job that made the tiles stale
+    int predicted_points{-1};
+    float predicted_tolerance{-1};  // negative for uniform samples
+    float predicted_x_start{0};
+    float predicted_x_end{0};
+};
+
+/// The prediction of CurveModel when no callback is given, empty for monostate
+void predict_curve(CurveSolver& solver, float x_start, float x_end, int num_points,
+                   std::vector<Point>& out);
+
+/// Samples the solver's evaluate by sample_adaptive, empty for monostate. Returns the number of
+/// evaluations.
+int sample_curve(CurveSolver& solver, float x_start, float x_end, const AdaptiveOptions& opts,
+                 std::vector<Point>& out);
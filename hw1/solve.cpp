@@ -1,55 +1,104 @@
 #include "solve.hpp"
+#include "profiler.hpp"
 
 #include <Eigen/Dense>
+#include <Eigen/SparseCholesky>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SOLVE_USE_SSE2 1
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <future>
 #include <iostream>
+#include <memory>
+#include <thread>
+#include <utility>
 
-Normalizer::Normalizer(const std::vector<Point>& points)
-    : mean_x{0}
-    , mean_y{0}
-    , std_x{0}
-    , std_y{0}
+void predict_polynomial(const Normalizer& norm, const float* coeff, int num_coeff, float x_start,
+                        float x_end, int num_points, Point* out)
 {
-    for (const auto& p : points) {
-        mean_x += p.x;
-        mean_y += p.y;
-    }
-    mean_x /= points.size();
-    mean_y /= points.size();
+    static_assert(sizeof(Point) == 2 * sizeof(float), "Point is written as interleaved floats");
 
-    for (const auto& p : points) {
-        std_x += (p.x - mean_x) * (p.x - mean_x);
-        std_y += (p.y - mean_y) * (p.y - mean_y);
-    }
-    std_x /= points.size() - 1;
-    std_y /= points.size() - 1;
-    std_x = sqrt(std_x);
-    std_y = sqrt(std_y);
-}
+    const float step = (x_end - x_start) / (num_points - 1);
+    // normalize_x and denormalize_y folded into a single multiply-add each
+    const float scale_x = 1.0f / norm.std_x;
+    const float offset_x = -norm.mean_x / norm.std_x;
+    const float scale_y = norm.std_y;
+    const float offset_y = norm.mean_y;
+    const float top = num_coeff > 0 ? coeff[num_coeff - 1] : 0.0f;
 
-float Normalizer::normalize_x(float x)
-{
-    return (x - mean_x) / std_x;
-}
+    float* dst = reinterpret_cast<float*>(out);
+    int i = 0;
 
-float Normalizer::normalize_y(float y)
-{
-    return (y - mean_y) / std_y;
-}
+#if defined(__AVX2__)
+    const __m256 lane = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256 v_start = _mm256_set1_ps(x_start);
+    const __m256 v_step = _mm256_set1_ps(step);
+    const __m256 v_scale_x = _mm256_set1_ps(scale_x);
+    const __m256 v_offset_x = _mm256_set1_ps(offset_x);
+    const __m256 v_scale_y = _mm256_set1_ps(scale_y);
+    const __m256 v_offset_y = _mm256_set1_ps(offset_y);
+    for (; i + 8 <= num_points; i += 8) {
+        __m256 idx = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(i)), lane);
+        __m256 x = _mm256_add_ps(v_start, _mm256_mul_ps(idx, v_step));
+        __m256 t = _mm256_add_ps(_mm256_mul_ps(x, v_scale_x), v_offset_x);
+        __m256 h = _mm256_set1_ps(top);
+        for (int k = num_coeff - 2; k >= 0; k--) {
+            h = _mm256_add_ps(_mm256_mul_ps(h, t), _mm256_set1_ps(coeff[k]));
+        }
+        __m256 y = _mm256_add_ps(_mm256_mul_ps(h, v_scale_y), v_offset_y);
 
-float Normalizer::denormalize_x(float x)
-{
-    return x * std_x + mean_x;
-}
+        // x0 y0 x1 y1 | x4 y4 x5 y5 and x2 y2 x3 y3 | x6 y6 x7 y7, then fix up the 128-bit halves
+        __m256 lo = _mm256_unpacklo_ps(x, y);
+        __m256 hi = _mm256_unpackhi_ps(x, y);
+        _mm256_storeu_ps(dst + 2 * i, _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_storeu_ps(dst + 2 * i + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+#elif defined(SOLVE_USE_SSE2)
+    const __m128 lane = _mm_setr_ps(0, 1, 2, 3);
+    const __m128 v_start = _mm_set1_ps(x_start);
+    const __m128 v_step = _mm_set1_ps(step);
+    const __m128 v_scale_x = _mm_set1_ps(scale_x);
+    const __m128 v_offset_x = _mm_set1_ps(offset_x);
+    const __m128 v_scale_y = _mm_set1_ps(scale_y);
+    const __m128 v_offset_y = _mm_set1_ps(offset_y);
+    for (; i + 4 <= num_points; i += 4) {
+        __m128 idx = _mm_add_ps(_mm_set1_ps(static_cast<float>(i)), lane);
+        __m128 x = _mm_add_ps(v_start, _mm_mul_ps(idx, v_step));
+        __m128 t = _mm_add_ps(_mm_mul_ps(x, v_scale_x), v_offset_x);
+        __m128 h = _mm_set1_ps(top);
+        for (int k = num_coeff - 2; k >= 0; k--) {
+            h = _mm_add_ps(_mm_mul_ps(h, t), _mm_set1_ps(coeff[k]));
+        }
+        __m128 y = _mm_add_ps(_mm_mul_ps(h, v_scale_y), v_offset_y);
 
-float Normalizer::denormalize_y(float y)
-{
-    return y * std_y + mean_y;
+        _mm_storeu_ps(dst + 2 * i, _mm_unpacklo_ps(x, y));
+        _mm_storeu_ps(dst + 2 * i + 4, _mm_unpackhi_ps(x, y));
+    }
+#endif
+
+    for (; i < num_points; i++) {
+        float x = x_start + static_cast<float>(i) * step;
+        float t = x * scale_x + offset_x;
+        float h = top;
+        for (int k = num_coeff - 2; k >= 0; k--) {
+            h = h * t + coeff[k];
+        }
+        out[i].x = x;
+        out[i].y = h * scale_y + offset_y;
+    }
 }
 
 MonomialInterpolation::MonomialInterpolation(const std::vector<Point>& points)
     : norm{points}
     , m{static_cast<int>(points.size())}
 {
+    PROFILE_SCOPE("MonomialInterpolation()");
     Matrixf A;
     Vectorf b;
 
@@ -80,25 +129,225 @@ MonomialInterpolation::MonomialInterpolation(const std::vector<Point>& points)
 
 std::vector<Point> MonomialInterpolation::predict(float x_start, float x_end, int num_points)
 {
+    std::vector<Point> ret;
+    ret.resize(num_points);
+    predict(x_start, x_end, num_points, ret.data());
+    return ret;
+}
+
+void MonomialInterpolation::predict(float x_start, float x_end, int num_points, Point* out)
+{
+    PROFILE_SCOPE("MonomialInterpolation::predict");
+    predict_polynomial(norm, coeff.data(), static_cast<int>(coeff.size()), x_start, x_end,
+                       num_points, out);
+}
+
+NewtonInterpolation::NewtonInterpolation(const std::vector<Point>& points)
+{
+    PROFILE_SCOPE("NewtonInterpolation()");
+    for (const auto& p : points) {
+        add_point(p);
+    }
+}
+
+void NewtonInterpolation::add_point(const Point& p)
+{
+    // Walk down the bottom diagonal of the divided difference table, only the previous diagonal
+    // is needed to produce the new one.
+    double x = p.x;
+    double prev = p.y;
+    for (int k = 0; k < m; k++) {
+        double next = (prev - last[k]) / (x - xs[m - 1 - k]);
+        last[k] = prev;
+        prev = next;
+    }
+    last.push_back(prev);
+    coeff.push_back(prev);
+    xs.push_back(x);
+    ys.push_back(p.y);
+    m++;
+}
+
+void NewtonInterpolation::remove_point(int i)
+{
+    if (i < 0 || i >= m) {
+        return;
+    }
+
+    if (i == m - 1) {
+        // Undo add_point, the leading coefficients are untouched and the previous bottom diagonal
+        // follows from last[k + 1] = (last[k] - prev[k]) / (x_{m-1} - x_{m-2-k}).
+        for (int k = 0; k < m - 1; k++) {
+            last[k] = last[k] - last[k + 1] * (xs[m - 1] - xs[m - 2 - k]);
+        }
+        last.pop_back();
+        coeff.pop_back();
+        xs.pop_back();
+        ys.pop_back();
+        m--;
+        return;
+    }
+
+    xs.erase(xs.begin() + i);
+    ys.erase(ys.begin() + i);
+    m--;
+
+    // Rebuild the whole table in place, column by column
+    coeff = ys;
+    last.resize(m);
+    last[0] = coeff[m - 1];
+    for (int k = 1; k < m; k++) {
+        for (int j = m - 1; j >= k; j--) {
+            coeff[j] = (coeff[j] - coeff[j - 1]) / (xs[j] - xs[j - k]);
+        }
+        last[k] = coeff[m - 1];
+    }
+}
+
+void NewtonInterpolation::clear()
+{
+    m = 0;
+    xs.clear();
+    ys.clear();
+    coeff.clear();
+    last.clear();
+}
+
+float NewtonInterpolation::evaluate(float x) const
+{
+    double y = 0;
+    for (int k = m - 1; k >= 0; k--) {
+        y = y * (x - xs[k]) + coeff[k];
+    }
+    return static_cast<float>(y);
+}
+
+std::vector<Point> NewtonInterpolation::predict(float x_start, float x_end, int num_points) const
+{
+    PROFILE_SCOPE("NewtonInterpolation::predict");
     auto step = (x_end - x_start) / (num_points - 1);
     float x = x_start;
 
     std::vector<Point> ret;
     ret.resize(num_points);
-
-    Matrixf A(num_points, m);
     for (int i = 0; i < num_points; i++, x += step) {
         ret[i].x = x;
+        ret[i].y = evaluate(x);
+    }
+    return ret;
+}
 
-        float normalized_x = norm.normalize_x(x);
-        A(i, 0) = 1.0;
-        for (int j = 1; j < m; j++) {
-            A(i, j) = A(i, j - 1) * normalized_x;
+BarycentricInterpolation::BarycentricInterpolation(const std::vector<Point>& points)
+{
+    xs.reserve(points.size());
+    ys.reserve(points.size());
+    log_ws.reserve(points.size());
+    signs.reserve(points.size());
+    for (const auto& p : points) {
+        add_point(p);
+    }
+}
+
+void BarycentricInterpolation::add_point(const Point& p)
+{
+    double x = p.x;
+
+    // Every old weight gains one factor 1 / (x_j - x), the new one is the product of all of them
+    double log_w = 0;
+    double sign = 1;
+    for (int j = 0; j < m; j++) {
+        double d = xs[j] - x;
+        double log_d = std::log(std::abs(d));
+        log_ws[j] -= log_d;
+        log_w -= log_d;
+        if (d < 0) {
+            signs[j] = -signs[j];
+        }
+        else {
+            sign = -sign;
         }
     }
-    Vectorf ys = A * coeff;
-    for (int i = 0; i < num_points; i++) {
-        ret[i].y = norm.denormalize_y(ys(i));
+
+    xs.push_back(x);
+    ys.push_back(p.y);
+    log_ws.push_back(log_w);
+    signs.push_back(sign);
+    m++;
+    rescale();
+}
+
+void BarycentricInterpolation::remove_point(int i)
+{
+    if (i < 0 || i >= m) {
+        return;
+    }
+
+    for (int j = 0; j < m; j++) {
+        if (j == i) {
+            continue;
+        }
+        double d = xs[j] - xs[i];
+        log_ws[j] += std::log(std::abs(d));
+        if (d < 0) {
+            signs[j] = -signs[j];
+        }
+    }
+    xs.erase(xs.begin() + i);
+    ys.erase(ys.begin() + i);
+    log_ws.erase(log_ws.begin() + i);
+    signs.erase(signs.begin() + i);
+    m--;
+    rescale();
+}
+
+void BarycentricInterpolation::clear()
+{
+    m = 0;
+    xs.clear();
+    ys.clear();
+    log_ws.clear();
+    signs.clear();
+    ws.clear();
+}
+
+void BarycentricInterpolation::rescale()
+{
+    double max_log_w = -std::numeric_limits<double>::infinity();
+    for (auto log_w : log_ws) {
+        max_log_w = std::max(max_log_w, log_w);
+    }
+    ws.resize(m);
+    for (int j = 0; j < m; j++) {
+        ws[j] = signs[j] * std::exp(log_ws[j] - max_log_w);
+    }
+}
+
+float BarycentricInterpolation::evaluate(float x) const
+{
+    double num = 0;
+    double den = 0;
+    for (int j = 0; j < m; j++) {
+        double d = x - xs[j];
+        if (d == 0) {
+            return static_cast<float>(ys[j]);
+        }
+        double t = ws[j] / d;
+        num += t * ys[j];
+        den += t;
+    }
+    return static_cast<float>(num / den);
+}
+
+std::vector<Point> BarycentricInterpolation::predict(float x_start, float x_end, int num_points)
+{
+    auto step = (x_end - x_start) / (num_points - 1);
+    float x = x_start;
+
+    std::vector<Point> ret;
+    ret.resize(num_points);
+    for (int i = 0; i < num_points; i++, x += step) {
+        ret[i].x = x;
+        ret[i].y = evaluate(x);
     }
     return ret;
 }
@@ -118,34 +367,20 @@ GaussInterpolation::GaussInterpolation(float sigma, const std::vector<Point>& po
     : m{static_cast<int>(points.size())}
     , sigma{sigma}
 {
-    xs.resize(points.size());
+    PROFILE_SCOPE("GaussInterpolation()");
+    xs.resize(m);
+    Vectorf ys(m);
     for (int i = 0; i < m; i++) {
         // store them for prediction
         xs(i) = points[i].x;
+        ys(i) = points[i].y;
     }
 
-    if (points.size() == 1) {
-        coeff.resize(m + 1);
-        coeff(0) = points[0].y;
-        coeff(1) = 0;
+    if (m < 2) {
+        solve(ys, 0, 0);
         return;
     }
 
-    Matrixf A;
-    Vectorf b;
-
-    A.resize(m + 1, m + 1);
-    b.resize(m + 1);
-    for (int i = 0; i < m; i++) {
-        float x_i = points[i].x;
-
-        A(i, 0) = 1.0;
-        b(i) = points[i].y;
-        for (int j = 1; j < m + 1; j++) {
-            A(i, j) = gauss(xs(j - 1), sigma, x_i);
-        }
-    }
-
     // Find the closest two point on x-axis and use the mid-point as last equation
     auto sorted_points = points;
     std::sort(sorted_points.begin(), sorted_points.end(),
@@ -163,6 +398,53 @@ GaussInterpolation::GaussInterpolation(float sigma, const std::vector<Point>& po
 
     float mid_x = (sorted_points[nearest + 1].x + sorted_points[nearest].x) * 0.5;
     float mid_y = (sorted_points[nearest + 1].y + sorted_points[nearest].y) * 0.5;
+    solve(ys, mid_x, mid_y);
+}
+
+GaussInterpolation::GaussInterpolation(float sigma, const PointSet& points)
+    : m{static_cast<int>(points.size())}
+    , sigma{sigma}
+{
+    PROFILE_SCOPE("GaussInterpolation()");
+    // store them for prediction
+    xs = points.x_map();
+
+    if (m < 2) {
+        solve(points.y_map(), 0, 0);
+        return;
+    }
+
+    // the closest pair on x-axis is tracked by the point set, no sort needed
+    auto [a, b] = points.closest_pair();
+    float mid_x = (points.x(a) + points.x(b)) * 0.5;
+    float mid_y = (points.y(a) + points.y(b)) * 0.5;
+    solve(points.y_map(), mid_x, mid_y);
+}
+
+void GaussInterpolation::solve(const Eigen::Ref<const Vectorf>& ys, float mid_x, float mid_y)
+{
+    if (m == 1) {
+        coeff.resize(m + 1);
+        coeff(0) = ys(0);
+        coeff(1) = 0;
+        sort_centers();
+        return;
+    }
+
+    Matrixf A;
+    Vectorf b;
+
+    A.resize(m + 1, m + 1);
+    b.resize(m + 1);
+    for (int i = 0; i < m; i++) {
+        float x_i = xs(i);
+
+        A(i, 0) = 1.0;
+        b(i) = ys(i);
+        for (int j = 1; j < m + 1; j++) {
+            A(i, j) = gauss(xs(j - 1), sigma, x_i);
+        }
+    }
 
     A(m, 0) = 1.0;
     b(m) = mid_y;
@@ -177,67 +459,216 @@ GaussInterpolation::GaussInterpolation(float sigma, const std::vector<Point>& po
         coeff.resize(m + 1);
         coeff.setConstant(std::numeric_limits<float>::quiet_NaN());
     }
+    sort_centers();
 }
 
-std::vector<Point> GaussInterpolation::predict(float x_start, float x_end, int num_points)
+namespace
 {
-    auto step = (x_end - x_start) / (num_points - 1);
-    float x = x_start;
 
-    std::vector<Point> ret;
-    ret.resize(num_points);
+/// Applies the Gauss kernel matrix over the sorted xs to v. Entries below float precision are
+/// skipped, which leaves a contiguous window of neighbours per row.
+class GaussKernelOperator
+{
+public:
+    GaussKernelOperator(const Vectorf& xs, float sigma)
+        : xs{xs}
+        , inv_two_sigma2{1.0f / (2 * sigma * sigma)}
+        , cutoff{sigma * std::sqrt(-2.0f * std::log(std::numeric_limits<float>::epsilon()))}
+    {
+    }
 
-    Matrixf A(num_points, m + 1);
-    for (int i = 0; i < num_points; i++, x += step) {
-        ret[i].x = x;
+    void apply(const Vectorf& v, Vectorf& out) const
+    {
+        const int n = static_cast<int>(xs.size());
+        int lo = 0;
+        int hi = 0;
+        for (int i = 0; i < n; i++) {
+            float x_i = xs(i);
+            while (xs(lo) < x_i - cutoff) {
+                lo++;
+            }
+            while (hi < n && xs(hi) <= x_i + cutoff) {
+                hi++;
+            }
+            int len = hi - lo;
+            out(i) = ((xs.segment(lo, len).array() - x_i).square() * -inv_two_sigma2)
+                         .exp()
+                         .matrix()
+                         .dot(v.segment(lo, len));
+        }
+    }
 
-        A(i, 0) = 1.0;
-        for (int j = 1; j < m + 1; j++) {
-            A(i, j) = gauss(xs(j - 1), sigma, x);
+private:
+    const Vectorf& xs;
+    float inv_two_sigma2;
+    float cutoff;
+};
+
+/// Inverts the diagonal blocks of consecutive sorted points, which hold the strongest couplings
+class BlockJacobiPreconditioner
+{
+public:
+    BlockJacobiPreconditioner(const Vectorf& xs, float sigma, int block_size)
+        : block_size{std::max(block_size, 1)}
+    {
+        const int n = static_cast<int>(xs.size());
+        for (int beg = 0; beg < n; beg += this->block_size) {
+            int len = std::min(this->block_size, n - beg);
+            Matrixf K(len, len);
+            for (int i = 0; i < len; i++) {
+                for (int j = 0; j < len; j++) {
+                    K(i, j) = gauss(xs(beg + j), sigma, xs(beg + i));
+                }
+            }
+            // a small shift keeps the blocks of nearly coincident points invertible
+            K.diagonal().array() += 1e-5f;
+            blocks.emplace_back(K);
         }
     }
 
-    Vectorf ys = A * coeff;
-    for (int i = 0; i < num_points; i++) {
-        ret[i].y = ys(i);
+    void apply(const Vectorf& r, Vectorf& out) const
+    {
+        for (size_t b = 0; b < blocks.size(); b++) {
+            int beg = static_cast<int>(b) * block_size;
+            int len = static_cast<int>(blocks[b].rows());
+            out.segment(beg, len) = blocks[b].solve(r.segment(beg, len));
+        }
     }
-    return ret;
-}
 
-LeastSquare::LeastSquare(int m, const std::vector<Point>& points)
-    : norm{points}
-    , m{m}
+private:
+    int block_size;
+    std::vector<Eigen::LDLT<Matrixf>> blocks;
+};
+
+/// Solves K x = b by preconditioned conjugate gradient from x = 0. On badly conditioned systems
+/// float CG stagnates or drifts, so the iterate of the lowest residual is returned. Adds the
+/// iterations taken and returns the relative residual reached.
+float solve_cg(const GaussKernelOperator& K, const BlockJacobiPreconditioner& M, const Vectorf& b,
+               const IterativeOptions& opts, Vectorf& best_x, int& iterations)
 {
-    Matrixf A;
-    Vectorf b;
+    const int n = static_cast<int>(b.size());
+    Vectorf x = Vectorf::Zero(n);
+    Vectorf r = b;
+    Vectorf z(n);
+    Vectorf p(n);
+    Vectorf Ap(n);
 
-    float x;
-    float y;
+    best_x = x;
+    float b_norm = b.norm();
+    if (!(b_norm > 0)) {
+        return 0;
+    }
+    M.apply(r, z);
+    p = z;
+    float rz = r.dot(z);
+    float residual = 1;
+    int k = 0;
+    for (; k < opts.max_iter; k++) {
+        K.apply(p, Ap);
+        float pAp = p.dot(Ap);
+        if (!(pAp > 0)) {
+            break; // positive definiteness lost to rounding
+        }
+        float alpha = rz / pAp;
+        x += alpha * p;
+        r -= alpha * Ap;
 
-    A.resize(points.size(), m + 1);
-    b.resize(points.size());
-    for (int i = 0; i < points.size(); i++) {
-        x = norm.normalize_x(points[i].x);
-        y = norm.normalize_y(points[i].y);
+        float new_residual = r.norm() / b_norm;
+        if (new_residual < residual) {
+            residual = new_residual;
+            best_x = x;
+        }
+        if (new_residual <= opts.tol) {
+            k++;
+            break;
+        }
 
-        A(i, 0) = 1.0;
-        b(i) = y;
-        for (int j = 1; j < m + 1; j++) {
-            A(i, j) = A(i, j - 1) * x;
+        M.apply(r, z);
+        float rz_next = r.dot(z);
+        p = z + (rz_next / rz) * p;
+        rz = rz_next;
+    }
+    iterations += k;
+    return residual;
+}
+} // namespace
+
+GaussInterpolation::GaussInterpolation(float sigma, const std::vector<Point>& points,
+                                       const IterativeOptions& opts)
+    : m{static_cast<int>(points.size())}
+    , sigma{sigma}
+{
+    PROFILE_SCOPE("GaussInterpolation() CG");
+    // Sorted xs make the significant part of every kernel row a contiguous window
+    xs.resize(m);
+    Vectorf ys(m);
+    std::vector<int> order(m);
+    for (int i = 0; i < m; i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(),
+              [&](int a, int b) { return points[a].x < points[b].x; });
+    for (int i = 0; i < m; i++) {
+        xs(i) = points[order[i]].x;
+        ys(i) = points[order[i]].y;
+    }
+
+    coeff.resize(m + 1);
+    if (m < 2) {
+        // as the dense path, a single point is its constant term
+        coeff(0) = m ? ys(0) : std::numeric_limits<float>::quiet_NaN();
+        coeff.tail(m).setZero();
+        sort_centers();
+        return;
+    }
+
+    // the mid-point of the closest pair is the extra equation, as in the dense path
+    int nearest = 0;
+    for (int i = 1; i + 1 < m; i++) {
+        if (xs(i + 1) - xs(i) < xs(nearest + 1) - xs(nearest)) {
+            nearest = i;
         }
     }
+    float mid_x = (xs(nearest) + xs(nearest + 1)) * 0.5f;
+    float mid_y = (ys(nearest) + ys(nearest + 1)) * 0.5f;
+
+    // The system [1 K; 1 k^T] [c_0; w] = [y; mid_y], with k_j = g_j(mid_x), is not symmetric.
+    // Eliminating w = K^-1 (y - c_0) leaves the scalar Schur complement
+    // c_0 (1 - k^T K^-1 1) = mid_y - k^T K^-1 y, so two CG solves with the symmetric positive
+    // definite K give the same interpolant.
+    GaussKernelOperator K{xs, sigma};
+    BlockJacobiPreconditioner M{xs, sigma, opts.block_size};
+    Vectorf u;
+    Vectorf v;
+    iterations = 0;
+    residual = solve_cg(K, M, ys, opts, u, iterations);
+    residual = std::max(residual, solve_cg(K, M, Vectorf::Ones(m), opts, v, iterations));
 
-    if (points.size()) {
-        coeff = (A.transpose() * A).ldlt().solve(A.transpose() * b);
+    double k_u = 0;
+    double k_v = 0;
+    for (int j = 0; j < m; j++) {
+        double k_j = gauss(xs(j), sigma, mid_x);
+        k_u += k_j * u(j);
+        k_v += k_j * v(j);
     }
-    else {
-        coeff.resize(m + 1);
-        coeff.setConstant(std::numeric_limits<float>::quiet_NaN());
+    double schur = 1 - k_v;
+    coeff(0) = schur != 0 ? static_cast<float>((mid_y - k_u) / schur) : 0.0f;
+    coeff.tail(m) = u - coeff(0) * v;
+    sort_centers();
+}
+
+float GaussInterpolation::evaluate(float x) const
+{
+    float y = coeff(0);
+    for (int j = 0; j < m; j++) {
+        y += coeff(j + 1) * gauss(xs(j), sigma, x);
     }
+    return y;
 }
 
-std::vector<Point> LeastSquare::predict(float x_start, float x_end, int num_points)
+std::vector<Point> GaussInterpolation::predict(float x_start, float x_end, int num_points)
 {
+    PROFILE_SCOPE("GaussInterpolation::predict");
     auto step = (x_end - x_start) / (num_points - 1);
     float x = x_start;
 
@@ -248,80 +679,1264 @@ std::vector<Point> LeastSquare::predict(float x_start, float x_end, int num_poin
     for (int i = 0; i < num_points; i++, x += step) {
         ret[i].x = x;
 
-        float normalized_x = norm.normalize_x(x);
         A(i, 0) = 1.0;
         for (int j = 1; j < m + 1; j++) {
-            A(i, j) = A(i, j - 1) * normalized_x;
+            A(i, j) = gauss(xs(j - 1), sigma, x);
         }
     }
+
     Vectorf ys = A * coeff;
     for (int i = 0; i < num_points; i++) {
-        ret[i].y = norm.denormalize_y(ys(i));
+        ret[i].y = ys(i);
     }
     return ret;
 }
 
-RidgeRegression::RidgeRegression(int m, float a, const std::vector<Point>& points)
-    : norm{points}
-    , m{m}
-    , a{a}
+void GaussInterpolation::sort_centers()
 {
-    Matrixf A;
-    Vectorf b;
-
-    float x;
-    float y;
-
-    A.resize(points.size(), m + 1);
-    b.resize(points.size());
-    for (int i = 0; i < points.size(); i++) {
-        x = norm.normalize_x(points[i].x);
-        y = norm.normalize_y(points[i].y);
-
-        A(i, 0) = 1.0;
-        b(i) = y;
-        for (int j = 1; j < m + 1; j++) {
-            A(i, j) = A(i, j - 1) * x;
-        }
+    std::vector<int> order(m);
+    for (int i = 0; i < m; i++) {
+        order[i] = i;
     }
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return xs(a) < xs(b); });
 
-    if (points.size()) {
-        Matrixf AT_A = A.transpose() * A;
-        AT_A.diagonal().array() += a;
-        if (a > 0) {
-            coeff = AT_A.llt().solve(A.transpose() * b);
-        }
-        else {
-            coeff = AT_A.ldlt().solve(A.transpose() * b);
-        }
-    }
-    else {
-        coeff.resize(m + 1);
-        coeff.setConstant(std::numeric_limits<float>::quiet_NaN());
+    sorted_xs.resize(m);
+    sorted_coeff.resize(m);
+    for (int i = 0; i < m; i++) {
+        sorted_xs(i) = xs(order[i]);
+        sorted_coeff(i) = coeff(order[i] + 1);
     }
 }
 
-std::vector<Point> RidgeRegression::predict(float x_start, float x_end, int num_points)
+std::vector<Point> GaussInterpolation::predict_truncated(float x_start, float x_end, int num_points,
+                                                         float max_error, float* exact_error)
 {
+    PROFILE_SCOPE("GaussInterpolation::predict_truncated");
     auto step = (x_end - x_start) / (num_points - 1);
     float x = x_start;
 
     std::vector<Point> ret;
     ret.resize(num_points);
 
-    Matrixf A(num_points, m + 1);
+    // Every dropped term is at most exp(-r^2 / (2 sigma^2)) * |c_j|, so the radius follows from
+    // bounding the sum of all |c_j|
+    float abs_sum = sorted_coeff.cwiseAbs().sum();
+    float radius = 0;
+    if (abs_sum > max_error) {
+        radius = sigma * std::sqrt(2 * std::log(abs_sum / max_error));
+    }
+    const float inv_two_sigma2 = 1.0f / (2 * sigma * sigma);
+
+    const float* begin = sorted_xs.data();
+    const float* end = begin + m;
+    int lo = 0;
+    int hi = 0;
     for (int i = 0; i < num_points; i++, x += step) {
+        if (step >= 0) {
+            while (lo < m && sorted_xs(lo) < x - radius) {
+                lo++;
+            }
+            hi = std::max(hi, lo);
+            while (hi < m && sorted_xs(hi) <= x + radius) {
+                hi++;
+            }
+        }
+        else {
+            lo = static_cast<int>(std::lower_bound(begin, end, x - radius) - begin);
+            hi = static_cast<int>(std::upper_bound(begin, end, x + radius) - begin);
+        }
+
+        int len = hi - lo;
         ret[i].x = x;
+        ret[i].y = coeff(0) + ((sorted_xs.segment(lo, len).array() - x).square() * -inv_two_sigma2)
+                                  .exp()
+                                  .matrix()
+                                  .dot(sorted_coeff.segment(lo, len));
+    }
+
+    if (exact_error) {
+        auto exact = predict(x_start, x_end, num_points);
+        *exact_error = 0;
+        for (int i = 0; i < num_points; i++) {
+            *exact_error = std::max(*exact_error, std::abs(exact[i].y - ret[i].y));
+        }
+    }
+    return ret;
+}
+
+namespace
+{
+
+/// Wendland's phi_{3,1}, positive definite in up to three dimensions, r is in units of the support
+double wendland(double r)
+{
+    if (r >= 1) {
+        return 0;
+    }
+    double s = (1 - r) * (1 - r);
+    return s * s * (4 * r + 1);
+}
+} // namespace
+
+WendlandInterpolation::WendlandInterpolation(float sigma, const std::vector<Point>& points)
+    : m{static_cast<int>(points.size())}
+    , sigma{sigma}
+    , mean_y{0}
+{
+    PROFILE_SCOPE("WendlandInterpolation()");
+    // Sorting the basis makes the support of each row a contiguous band
+    std::vector<int> order(m);
+    for (int i = 0; i < m; i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(),
+              [&](int a, int b) { return points[a].x < points[b].x; });
+
+    Vectorf b;
+    xs.resize(m);
+    b.resize(m);
+    for (int i = 0; i < m; i++) {
+        xs(i) = points[order[i]].x;
+        b(i) = points[order[i]].y;
+        mean_y += b(i);
+    }
+
+    if (m == 0) {
+        return;
+    }
+    mean_y /= m;
+    b.array() -= mean_y;
+
+    // Only the lower triangle is referenced by the factorization
+    std::vector<Eigen::Triplet<double>> triplets;
+    for (int j = 0; j < m; j++) {
+        triplets.emplace_back(j, j, 1.0);
+        for (int i = j + 1; i < m && xs(i) - xs(j) < sigma; i++) {
+            triplets.emplace_back(i, j, wendland((double(xs(i)) - xs(j)) / sigma));
+        }
+    }
+
+    Eigen::SparseMatrix<double> A(m, m);
+    A.setFromTriplets(triplets.begin(), triplets.end());
+
+    // The band is already as narrow as it gets, a fill-reducing permutation would only widen it
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>, Eigen::Lower, Eigen::NaturalOrdering<int>>
+        ldlt(A);
+    if (ldlt.info() == Eigen::Success) {
+        coeff = ldlt.solve(b.cast<double>()).cast<float>();
+    }
+    else {
+        coeff.resize(m);
+        coeff.setConstant(std::numeric_limits<float>::quiet_NaN());
+    }
+}
+
+float WendlandInterpolation::evaluate(float x) const
+{
+    // Only the basis within one support radius contributes
+    const float* first = std::lower_bound(xs.data(), xs.data() + m, x - sigma);
+    double y = mean_y;
+    for (int j = static_cast<int>(first - xs.data()); j < m && xs(j) < x + sigma; j++) {
+        y += coeff(j) * wendland(std::abs(double(x) - xs(j)) / sigma);
+    }
+    return static_cast<float>(y);
+}
+
+std::vector<Point> WendlandInterpolation::predict(float x_start, float x_end, int num_points)
+{
+    PROFILE_SCOPE("WendlandInterpolation::predict");
+    auto step = (x_end - x_start) / (num_points - 1);
+    float x = x_start;
+
+    std::vector<Point> ret;
+    ret.resize(num_points);
+    for (int i = 0; i < num_points; i++, x += step) {
+        ret[i].x = x;
+        ret[i].y = evaluate(x);
+    }
+    return ret;
+}
+
+namespace
+{
+
+/// Solves the symmetric positive semidefinite system A x = b of size N in place by LDL^T with
+/// diagonal pivoting, as Eigen's LDLT does. Components along pivots that vanish are set to zero.
+template <typename Scalar, int N>
+void solve_ldlt_fixed(Scalar (&A)[N][N], Scalar (&b)[N], Scalar (&x)[N])
+{
+    int perm[N];
+    for (int i = 0; i < N; i++) {
+        perm[i] = i;
+    }
+
+    Scalar max_pivot = 0;
+    for (int i = 0; i < N; i++) {
+        max_pivot = std::max(max_pivot, std::abs(A[i][i]));
+    }
+    const Scalar tiny = max_pivot * N * std::numeric_limits<Scalar>::epsilon();
+
+    for (int k = 0; k < N; k++) {
+        int p = k;
+        for (int i = k + 1; i < N; i++) {
+            if (std::abs(A[i][i]) > std::abs(A[p][p]))
+                p = i;
+        }
+        if (p != k) {
+            for (int i = 0; i < N; i++) {
+                std::swap(A[k][i], A[p][i]);
+            }
+            for (int i = 0; i < N; i++) {
+                std::swap(A[i][k], A[i][p]);
+            }
+            std::swap(b[k], b[p]);
+            std::swap(perm[k], perm[p]);
+        }
+
+        const Scalar d = A[k][k];
+        if (std::abs(d) <= tiny) {
+            // the remaining block is numerically zero
+            for (int i = k; i < N; i++) {
+                A[i][i] = 0;
+                for (int j = i + 1; j < N; j++) {
+                    A[j][i] = 0;
+                }
+            }
+            break;
+        }
+        for (int i = k + 1; i < N; i++) {
+            A[i][k] /= d;
+        }
+        for (int i = k + 1; i < N; i++) {
+            for (int j = k + 1; j <= i; j++) {
+                A[i][j] -= A[i][k] * A[j][k] * d;
+                A[j][i] = A[i][j];
+            }
+        }
+    }
+
+    // L y = b, D z = y, L^T w = z
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < i; j++) {
+            b[i] -= A[i][j] * b[j];
+        }
+    }
+    for (int i = 0; i < N; i++) {
+        b[i] = std::abs(A[i][i]) > tiny ? b[i] / A[i][i] : 0;
+    }
+    for (int i = N - 1; i >= 0; i--) {
+        for (int j = i + 1; j < N; j++) {
+            b[i] -= A[j][i] * b[j];
+        }
+    }
+    for (int i = 0; i < N; i++) {
+        x[perm[i]] = b[i];
+    }
+}
+
+/// Solves the Hankel system sum_j (x_powers[i + j] + a [i == j]) c_j = xy_powers[i] of order M
+/// without touching the heap except for the returned coefficients
+template <typename Scalar, int M>
+Vectorf solve_hankel_fixed(const Scalar* x_powers, const Scalar* xy_powers, Scalar a)
+{
+    Scalar AT_A[M + 1][M + 1];
+    Scalar AT_b[M + 1];
+    Scalar c[M + 1];
+    for (int i = 0; i <= M; i++) {
+        for (int j = 0; j <= M; j++) {
+            AT_A[i][j] = x_powers[i + j];
+        }
+        AT_A[i][i] += a;
+        AT_b[i] = xy_powers[i];
+    }
+    solve_ldlt_fixed<Scalar, M + 1>(AT_A, AT_b, c);
+
+    Vectorf coeff(M + 1);
+    for (int i = 0; i <= M; i++) {
+        coeff(i) = static_cast<float>(c[i]);
+    }
+    return coeff;
+}
+
+template <typename Scalar>
+Vectorf solve_hankel_dynamic(int m, const Scalar* x_powers, const Scalar* xy_powers, Scalar a)
+{
+    using Matrix = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
+    using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+    Matrix AT_A(m + 1, m + 1);
+    for (int i = 0; i <= m; i++) {
+        for (int j = 0; j <= m; j++) {
+            AT_A(i, j) = x_powers[i + j];
+        }
+    }
+    AT_A.diagonal().array() += a;
+    Vector AT_b = Eigen::Map<const Vector>(xy_powers, m + 1);
+    if (a > 0) {
+        return AT_A.llt().solve(AT_b).template cast<float>();
+    }
+    return AT_A.ldlt().solve(AT_b).template cast<float>();
+}
+
+/// The power sums of order M over all points, with the trip counts known at compile time
+template <typename Scalar, int M>
+Vectorf fit_polynomial_fixed(const std::vector<Point>& points, const Normalizer& norm, Scalar a)
+{
+    Scalar x_powers[2 * M + 1] = {};
+    Scalar xy_powers[M + 1] = {};
+    const Scalar scale_x = Scalar(1) / norm.std_x;
+    const Scalar scale_y = Scalar(1) / norm.std_y;
+    for (const auto& p : points) {
+        Scalar x = (p.x - norm.mean_x) * scale_x;
+        Scalar y = (p.y - norm.mean_y) * scale_y;
+
+        Scalar x_k = 1;
+        for (int k = 0; k <= M; k++) {
+            x_powers[k] += x_k;
+            xy_powers[k] += x_k * y;
+            x_k *= x;
+        }
+        for (int k = M + 1; k <= 2 * M; k++) {
+            x_powers[k] += x_k;
+            x_k *= x;
+        }
+    }
+    return solve_hankel_fixed<Scalar, M>(x_powers, xy_powers, a);
+}
+
+template <typename Scalar>
+Vectorf fit_polynomial_dynamic(int m, const std::vector<Point>& points, const Normalizer& norm,
+                               Scalar a)
+{
+    std::vector<Scalar> x_powers(2 * m + 1);
+    std::vector<Scalar> xy_powers(m + 1);
+    for (const auto& p : points) {
+        Scalar x = (p.x - norm.mean_x) / norm.std_x;
+        Scalar y = (p.y - norm.mean_y) / norm.std_y;
+
+        Scalar x_k = 1;
+        for (int k = 0; k <= 2 * m; k++) {
+            x_powers[k] += x_k;
+            if (k <= m) {
+                xy_powers[k] += x_k * y;
+            }
+            x_k *= x;
+        }
+    }
+    return solve_hankel_dynamic<Scalar>(m, x_powers.data(), xy_powers.data(), a);
+}
+
+/// Tables of the fixed order instantiations, indexed by the runtime order
+template <typename Scalar, int... Ms>
+struct FixedOrderTable
+{
+    using Fit = Vectorf (*)(const std::vector<Point>&, const Normalizer&, Scalar);
+    using Solve = Vectorf (*)(const Scalar*, const Scalar*, Scalar);
+    static constexpr Fit fit[] = {&fit_polynomial_fixed<Scalar, Ms>...};
+    static constexpr Solve solve[] = {&solve_hankel_fixed<Scalar, Ms>...};
+};
+
+template <typename Scalar, int... Ms>
+constexpr FixedOrderTable<Scalar, Ms...> make_fixed_order_table(
+    std::integer_sequence<int, Ms...>)
+{
+    return {};
+}
+
+template <typename Scalar>
+using FixedOrders = decltype(make_fixed_order_table<Scalar>(
+    std::make_integer_sequence<int, MAX_FIXED_ORDER + 1>{}));
+
+} // namespace
+
+template <typename Scalar>
+Vectorf fit_polynomial(int m, float a, const std::vector<Point>& points, const Normalizer& norm)
+{
+    PROFILE_SCOPE("fit_polynomial");
+    if (points.empty() || m < 0) {
+        Vectorf coeff(std::max(m, 0) + 1);
+        coeff.setConstant(std::numeric_limits<float>::quiet_NaN());
+        return coeff;
+    }
+    if (m <= MAX_FIXED_ORDER) {
+        return FixedOrders<Scalar>::fit[m](points, norm, a);
+    }
+    return fit_polynomial_dynamic<Scalar>(m, points, norm, a);
+}
+
+template Vectorf fit_polynomial<float>(int, float, const std::vector<Point>&, const Normalizer&);
+template Vectorf fit_polynomial<double>(int, float, const std::vector<Point>&, const Normalizer&);
+
+template <typename Scalar>
+BasicLeastSquare<Scalar>::BasicLeastSquare(int m, const std::vector<Point>& points)
+    : norm{points}
+    , m{m}
+    , coeff{fit_polynomial<Scalar>(m, 0, points, norm)}
+{
+}
+
+void PointStats::add(const Point& p)
+{
+    count += 1;
+    double dx = p.x - mean_x;
+    double dy = p.y - mean_y;
+    mean_x += dx / count;
+    mean_y += dy / count;
+    m2_x += dx * (p.x - mean_x);
+    m2_y += dy * (p.y - mean_y);
+}
+
+void PointStats::merge(const PointStats& other)
+{
+    if (other.count == 0) {
+        return;
+    }
+    double total = count + other.count;
+    double dx = other.mean_x - mean_x;
+    double dy = other.mean_y - mean_y;
+    mean_x += dx * other.count / total;
+    mean_y += dy * other.count / total;
+    m2_x += other.m2_x + dx * dx * count * other.count / total;
+    m2_y += other.m2_y + dy * dy * count * other.count / total;
+    count = total;
+}
+
+Normalizer PointStats::normalizer() const
+{
+    Normalizer norm;
+    norm.mean_x = static_cast<float>(mean_x);
+    norm.mean_y = static_cast<float>(mean_y);
+    norm.std_x = static_cast<float>(std::sqrt(m2_x / (count - 1)));
+    norm.std_y = static_cast<float>(std::sqrt(m2_y / (count - 1)));
+    return norm;
+}
+
+NormalEquations::NormalEquations(int m, const Normalizer& norm)
+    : m{m}
+    , norm{norm}
+    , x_powers{Eigen::VectorXd::Zero(2 * std::max(m, 0) + 1)}
+    , xy_powers{Eigen::VectorXd::Zero(std::max(m, 0) + 1)}
+{
+}
+
+namespace
+{
+
+/// Adds the powers of point i, read through x_at(i) and y_at(i), for i in [0, n)
+template <typename X, typename Y>
+void accumulate_powers(NormalEquations& eq, size_t n, X&& x_at, Y&& y_at)
+{
+    const int m = eq.m;
+    const double scale_x = 1.0 / eq.norm.std_x;
+    const double scale_y = 1.0 / eq.norm.std_y;
+    for (size_t i = 0; i < n; i++) {
+        double x = (x_at(i) - eq.norm.mean_x) * scale_x;
+        double y = (y_at(i) - eq.norm.mean_y) * scale_y;
+
+        double x_k = 1.0;
+        for (int k = 0; k <= m; k++) {
+            eq.x_powers(k) += x_k;
+            eq.xy_powers(k) += x_k * y;
+            x_k *= x;
+        }
+        for (int k = m + 1; k <= 2 * m; k++) {
+            eq.x_powers(k) += x_k;
+            x_k *= x;
+        }
+    }
+}
+} // namespace
+
+void NormalEquations::accumulate(const Point* points, size_t n)
+{
+    accumulate_powers(
+        *this, n, [&](size_t i) { return points[i].x; }, [&](size_t i) { return points[i].y; });
+}
+
+void NormalEquations::accumulate(const float* xs, const float* ys, size_t n)
+{
+    accumulate_powers(
+        *this, n, [&](size_t i) { return xs[i]; }, [&](size_t i) { return ys[i]; });
+}
+
+void NormalEquations::accumulate(const double* xs, const double* ys, size_t n)
+{
+    accumulate_powers(
+        *this, n, [&](size_t i) { return xs[i]; }, [&](size_t i) { return ys[i]; });
+}
+
+void NormalEquations::merge(const NormalEquations& other)
+{
+    x_powers += other.x_powers;
+    xy_powers += other.xy_powers;
+}
+
+Vectorf NormalEquations::solve(float a) const
+{
+    if (m < 0) {
+        // no polynomial to solve for, NaN as from no points
+        Vectorf coeff(1);
+        coeff.setConstant(std::numeric_limits<float>::quiet_NaN());
+        return coeff;
+    }
+    if (m <= MAX_FIXED_ORDER) {
+        return FixedOrders<double>::solve[m](x_powers.data(), xy_powers.data(), a);
+    }
+    return solve_hankel_dynamic<double>(m, x_powers.data(), xy_powers.data(), a);
+}
+
+namespace
+{
+
+/// opts.pool, or a pool of num_threads workers that lives as long as this
+class StreamPool
+{
+public:
+    StreamPool(const StreamOptions& opts, int num_threads)
+        : pool{opts.pool}
+    {
+        if (!pool) {
+            owned = std::make_unique<ThreadPool>(static_cast<unsigned>(num_threads));
+            pool = owned.get();
+        }
+    }
+
+    ThreadPool& operator*() const
+    {
+        return *pool;
+    }
+
+private:
+    std::unique_ptr<ThreadPool> owned;
+    ThreadPool* pool;
+};
+
+/// Waits for every task before rethrowing the exception of any of them, the tasks may still use
+/// what the caller is about to unwind
+void wait_all(std::vector<std::future<void>>& tasks)
+{
+    for (auto& task : tasks) {
+        if (task.valid()) {
+            task.wait();
+        }
+    }
+    for (auto& task : tasks) {
+        if (task.valid()) {
+            task.get();
+        }
+    }
+    tasks.clear();
+}
+
+int stream_threads(const StreamOptions& opts)
+{
+    if (opts.num_threads > 0) {
+        return opts.num_threads;
+    }
+    return static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+}
+} // namespace
+
+template <typename Scalar>
+NormalEquations accumulate_columns(int m, const Normalizer& norm, const Scalar* xs,
+                                   const Scalar* ys, size_t n, const StreamOptions& opts)
+{
+    // a task for less than a chunk is not worth handing out
+    size_t max_tasks = std::max<size_t>(1, n / std::max<size_t>(opts.chunk_size, 1));
+    int num_tasks = static_cast<int>(std::min<size_t>(stream_threads(opts), max_tasks));
+
+    std::vector<NormalEquations> partial(num_tasks, NormalEquations{m, norm});
+    auto work = [&](int t) {
+        size_t first = n * t / num_tasks;
+        size_t last = n * (t + 1) / num_tasks;
+        partial[t].accumulate(xs + first, ys + first, last - first);
+    };
+
+    if (num_tasks > 1) {
+        // the calling thread takes the first range
+        StreamPool pool{opts, num_tasks - 1};
+        std::vector<std::future<void>> tasks;
+        for (int t = 1; t < num_tasks; t++) {
+            tasks.push_back((*pool).submit([&work, t] { work(t); }));
+        }
+        work(0);
+        wait_all(tasks);
+    }
+    else {
+        work(0);
+    }
+    for (int t = 1; t < num_tasks; t++) {
+        partial[0].merge(partial[t]);
+    }
+    return partial[0];
+}
+
+template NormalEquations accumulate_columns<float>(int, const Normalizer&, const float*,
+                                                   const float*, size_t, const StreamOptions&);
+template NormalEquations accumulate_columns<double>(int, const Normalizer&, const double*,
+                                                    const double*, size_t, const StreamOptions&);
+
+namespace
+{
+
+/// Reads the source chunk by chunk on the calling thread and runs func(slot, chunk, size) for each
+/// chunk on the pool. Two sets of num_threads chunks take turns, one is filled while the pool works
+/// through the other, so that reading overlaps the sums. There are 2 * num_threads slots, and no
+/// two tasks of the same slot ever run at once.
+template <typename Func>
+void for_each_chunk(PointSource& source, size_t chunk_size, ThreadPool& pool, int num_threads,
+                    Func&& func)
+{
+    chunk_size = std::max<size_t>(chunk_size, 1);
+    std::vector<std::vector<Point>> chunks(2 * num_threads, std::vector<Point>(chunk_size));
+    std::vector<std::future<void>> tasks[2];
+
+    source.rewind();
+    try {
+        bool exhausted = false;
+        for (int set = 0; !exhausted; set ^= 1) {
+            // the chunks of this set were handed out two rounds ago
+            wait_all(tasks[set]);
+            for (int t = 0; t < num_threads; t++) {
+                int slot = set * num_threads + t;
+                Point* chunk = chunks[slot].data();
+                size_t n = source.fill(chunk, chunk_size);
+                if (n == 0) {
+                    exhausted = true;
+                    break;
+                }
+                auto task = [&func, slot, chunk, n] { func(slot, chunk, n); };
+                tasks[set].push_back(pool.submit(task));
+            }
+        }
+        wait_all(tasks[0]);
+        wait_all(tasks[1]);
+    }
+    catch (...) {
+        // a failed fill or sum leaves the other tasks reading the chunks
+        for (auto& set : tasks) {
+            for (auto& task : set) {
+                if (task.valid()) {
+                    task.wait();
+                }
+            }
+        }
+        throw;
+    }
+}
+} // namespace
+
+template <typename Scalar>
+BasicLeastSquare<Scalar>::BasicLeastSquare(int m, PointSource& source, const StreamOptions& opts)
+    : m{m}
+{
+    PROFILE_SCOPE("LeastSquare() streamed");
+    const int num_threads = stream_threads(opts);
+    const int num_slots = 2 * num_threads; // as for_each_chunk hands out
+    StreamPool pool{opts, num_threads};
+
+    // First pass, the normalizer has to be fixed before any power is taken
+    std::vector<PointStats> stats(num_slots);
+    for_each_chunk(source, opts.chunk_size, *pool, num_threads,
+                   [&](int slot, const Point* points, size_t n) {
+                       for (size_t i = 0; i < n; i++) {
+                           stats[slot].add(points[i]);
+                       }
+                   });
+    for (int t = 1; t < num_slots; t++) {
+        stats[0].merge(stats[t]);
+    }
+
+    if (stats[0].count == 0 || m < 0) {
+        coeff.resize(std::max(m, 0) + 1);
+        coeff.setConstant(std::numeric_limits<float>::quiet_NaN());
+        return;
+    }
+    norm = stats[0].normalizer();
+
+    // Second pass, every slot sums into its own normal equations
+    std::vector<NormalEquations> partial(num_slots, NormalEquations{m, norm});
+    for_each_chunk(source, opts.chunk_size, *pool, num_threads,
+                   [&](int slot, const Point* points, size_t n) {
+                       partial[slot].accumulate(points, n);
+                   });
+    for (int t = 1; t < num_slots; t++) {
+        partial[0].merge(partial[t]);
+    }
+    coeff = partial[0].solve();
+}
+
+namespace
+{
+
+/// The ridge fit of order m over the arrays, NaN if they are empty
+template <typename Vector>
+Vectorf fit_columns(int m, float a, const Vector& xs, const Vector& ys, const Normalizer& norm,
+                    const StreamOptions& opts)
+{
+    PROFILE_SCOPE("fit_columns");
+    if (xs.size() == 0 || m < 0) {
+        Vectorf coeff(std::max(m, 0) + 1);
+        coeff.setConstant(std::numeric_limits<float>::quiet_NaN());
+        return coeff;
+    }
+    auto n = static_cast<size_t>(std::min(xs.size(), ys.size()));
+    return accumulate_columns(m, norm, xs.data(), ys.data(), n, opts).solve(a);
+}
+} // namespace
+
+template <typename Scalar>
+BasicLeastSquare<Scalar>::BasicLeastSquare(int m, const Eigen::Ref<const Eigen::VectorXf>& xs,
+                                           const Eigen::Ref<const Eigen::VectorXf>& ys,
+                                           const Normalizer& norm, const StreamOptions& opts)
+    : norm{norm}
+    , m{m}
+    , coeff{fit_columns(m, 0, xs, ys, norm, opts)}
+{
+}
+
+template <typename Scalar>
+BasicLeastSquare<Scalar>::BasicLeastSquare(int m, const Eigen::Ref<const Eigen::VectorXd>& xs,
+                                           const Eigen::Ref<const Eigen::VectorXd>& ys,
+                                           const Normalizer& norm, const StreamOptions& opts)
+    : norm{norm}
+    , m{m}
+    , coeff{fit_columns(m, 0, xs, ys, norm, opts)}
+{
+}
+
+template <typename Scalar>
+std::vector<Point> BasicLeastSquare<Scalar>::predict(float x_start, float x_end, int num_points)
+{
+    std::vector<Point> ret;
+    ret.resize(num_points);
+    predict(x_start, x_end, num_points, ret.data());
+    return ret;
+}
+
+template <typename Scalar>
+void BasicLeastSquare<Scalar>::predict(float x_start, float x_end, int num_points, Point* out)
+{
+    PROFILE_SCOPE("LeastSquare::predict");
+    predict_polynomial(norm, coeff.data(), static_cast<int>(coeff.size()), x_start, x_end,
+                       num_points, out);
+}
+
+template struct BasicLeastSquare<float>;
+template struct BasicLeastSquare<double>;
+
+OrthogonalLeastSquare::OrthogonalLeastSquare(int m, const std::vector<Point>& points)
+    : norm{points}
+{
+    PROFILE_SCOPE("OrthogonalLeastSquare()");
+    int n = static_cast<int>(points.size());
+    if (n == 0) {
+        return;
+    }
+
+    xs.resize(n);
+    ys.resize(n);
+    for (int i = 0; i < n; i++) {
+        xs[i] = norm.normalize_x(points[i].x);
+        ys[i] = norm.normalize_y(points[i].y);
+    }
+
+    // p_0 = 1
+    p_prev.assign(n, 0.0);
+    p_cur.assign(n, 1.0);
+    residual = ys;
+    leverage.assign(n, 0.0);
+    push_order();
+
+    set_order(m);
+}
+
+int OrthogonalLeastSquare::fitted_order() const
+{
+    return static_cast<int>(coeff.size()) - 1;
+}
+
+void OrthogonalLeastSquare::push_order()
+{
+    // p_cur holds the newest basis, project y onto it and update the running residual
+    const int n = static_cast<int>(xs.size());
+    double pp = 0;
+    double yp = 0;
+    for (int i = 0; i < n; i++) {
+        pp += p_cur[i] * p_cur[i];
+        yp += ys[i] * p_cur[i];
+    }
+    double c = yp / pp;
+    norms.push_back(pp);
+    coeff.push_back(c);
+
+    // With an orthogonal basis the hat matrix is a sum of rank one projections, so both the
+    // residual and the leverages pick up one term per order. An order that interpolates a point,
+    // with a leverage of 1, cannot predict it left out and scores infinity.
+    double score = 0;
+    bool interpolates = false;
+    for (int i = 0; i < n; i++) {
+        residual[i] -= c * p_cur[i];
+        leverage[i] += p_cur[i] * p_cur[i] / pp;
+        interpolates = interpolates || leverage[i] > 1 - 1e-9;
+        double e = residual[i] / (1 - leverage[i]);
+        score += e * e;
+    }
+    loocv.push_back(interpolates ? std::numeric_limits<double>::infinity() : score / n);
+}
+
+bool OrthogonalLeastSquare::raise_order()
+{
+    const int n = static_cast<int>(xs.size());
+    const int k = fitted_order();
+    if (n == 0 || k + 1 >= n) {
+        return false;
+    }
+
+    double a = 0;
+    for (int i = 0; i < n; i++) {
+        a += xs[i] * p_cur[i] * p_cur[i];
+    }
+    a /= norms[k];
+    double b = k > 0 ? norms[k] / norms[k - 1] : 0;
+
+    std::vector<double> next(n);
+    double pp = 0;
+    for (int i = 0; i < n; i++) {
+        next[i] = (xs[i] - a) * p_cur[i] - b * p_prev[i];
+        pp += next[i] * next[i];
+    }
+
+    // Once the order reaches the number of distinct xs the new basis vanishes on the data
+    if (pp <= 1e-12 * norms[0]) {
+        return false;
+    }
+    p_prev = std::move(p_cur);
+    p_cur = std::move(next);
+
+    alpha.push_back(a);
+    beta.push_back(b);
+    push_order();
+    return true;
+}
+
+void OrthogonalLeastSquare::set_order(int m)
+{
+    while (fitted_order() < m && raise_order()) {
+    }
+    this->m = std::min(m, fitted_order());
+}
+
+int OrthogonalLeastSquare::best_order(int max_order)
+{
+    while (fitted_order() < max_order && raise_order()) {
+    }
+    int best = 0;
+    int last = std::min(max_order, fitted_order());
+    for (int k = 1; k <= last; k++) {
+        if (loocv[k] < loocv[best]) {
+            best = k;
+        }
+    }
+    return best;
+}
+
+float OrthogonalLeastSquare::evaluate(float x) const
+{
+    if (m < 0) {
+        return std::numeric_limits<float>::quiet_NaN();
+    }
+
+    double t = norm.normalize_x(x);
+    double p_k_1 = 0;
+    double p_k = 1;
+    double y = coeff[0];
+    for (int k = 0; k < m; k++) {
+        double next = (t - alpha[k]) * p_k - beta[k] * p_k_1;
+        p_k_1 = p_k;
+        p_k = next;
+        y += coeff[k + 1] * p_k;
+    }
+    return norm.denormalize_y(static_cast<float>(y));
+}
+
+std::vector<Point> OrthogonalLeastSquare::predict(float x_start, float x_end, int num_points)
+{
+    std::vector<Point> ret;
+    ret.resize(num_points);
+    predict(x_start, x_end, num_points, ret.data());
+    return ret;
+}
+
+void OrthogonalLeastSquare::predict(float x_start, float x_end, int num_points, Point* out)
+{
+    PROFILE_SCOPE("OrthogonalLeastSquare::predict");
+    const float step = (x_end - x_start) / (num_points - 1);
+    for (int i = 0; i < num_points; i++) {
+        out[i].x = x_start + static_cast<float>(i) * step;
+        out[i].y = evaluate(out[i].x);
+    }
+}
+
+template <typename Scalar>
+BasicRidgeRegression<Scalar>::BasicRidgeRegression(int m, float a, const std::vector<Point>& points)
+    : norm{points}
+    , m{m}
+    , a{a}
+    , coeff{fit_polynomial<Scalar>(m, a, points, norm)}
+{
+}
+
+template <typename Scalar>
+float BasicRidgeRegression<Scalar>::evaluate(float x) const
+{
+    float t = (x - norm.mean_x) / norm.std_x;
+    float y = 0;
+    for (int k = static_cast<int>(coeff.size()) - 1; k >= 0; k--) {
+        y = y * t + coeff(k);
+    }
+    return y * norm.std_y + norm.mean_y;
+}
+
+template <typename Scalar>
+BasicRidgeRegression<Scalar>::BasicRidgeRegression(int m, float a,
+                                                   const Eigen::Ref<const Eigen::VectorXf>& xs,
+                                                   const Eigen::Ref<const Eigen::VectorXf>& ys,
+                                                   const Normalizer& norm,
+                                                   const StreamOptions& opts)
+    : norm{norm}
+    , m{m}
+    , a{a}
+    , coeff{fit_columns(m, a, xs, ys, norm, opts)}
+{
+}
+
+template <typename Scalar>
+BasicRidgeRegression<Scalar>::BasicRidgeRegression(int m, float a,
+                                                   const Eigen::Ref<const Eigen::VectorXd>& xs,
+                                                   const Eigen::Ref<const Eigen::VectorXd>& ys,
+                                                   const Normalizer& norm,
+                                                   const StreamOptions& opts)
+    : norm{norm}
+    , m{m}
+    , a{a}
+    , coeff{fit_columns(m, a, xs, ys, norm, opts)}
+{
+}
+
+template <typename Scalar>
+std::vector<Point> BasicRidgeRegression<Scalar>::predict(float x_start, float x_end,
+                                                         int num_points)
+{
+    std::vector<Point> ret;
+    ret.resize(num_points);
+    predict(x_start, x_end, num_points, ret.data());
+    return ret;
+}
+
+template <typename Scalar>
+void BasicRidgeRegression<Scalar>::predict(float x_start, float x_end, int num_points, Point* out)
+{
+    PROFILE_SCOPE("RidgeRegression::predict");
+    predict_polynomial(norm, coeff.data(), static_cast<int>(coeff.size()), x_start, x_end,
+                       num_points, out);
+}
+
+template struct BasicRidgeRegression<float>;
+template struct BasicRidgeRegression<double>;
+
+RidgeRegressionPath::RidgeRegressionPath(int m, const std::vector<Point>& points)
+    : norm{points}
+    , m{m}
+    , n{static_cast<int>(points.size())}
+    , outside_norm2{0}
+{
+    PROFILE_SCOPE("RidgeRegressionPath()");
+    Eigen::MatrixXd A(n, m + 1);
+    Eigen::VectorXd b(n);
+    for (int i = 0; i < n; i++) {
+        double x = norm.normalize_x(points[i].x);
+        b(i) = norm.normalize_y(points[i].y);
 
-        float normalized_x = norm.normalize_x(x);
         A(i, 0) = 1.0;
         for (int j = 1; j < m + 1; j++) {
-            A(i, j) = A(i, j - 1) * normalized_x;
+            A(i, j) = A(i, j - 1) * x;
         }
     }
-    Vectorf ys = A * coeff;
+
+    if (n == 0) {
+        return;
+    }
+
+    // U is n x (m + 1), it is only needed once to project b
+    Eigen::BDCSVD<Eigen::MatrixXd> svd(A, Eigen::ComputeThinU | Eigen::ComputeThinV);
+    s = svd.singularValues();
+    V = svd.matrixV();
+    Utb = svd.matrixU().transpose() * b;
+    outside_norm2 = std::max(0.0, b.squaredNorm() - Utb.squaredNorm());
+}
+
+RidgeRegression RidgeRegressionPath::solve(float a) const
+{
+    RidgeRegression rr;
+    rr.norm = norm;
+    rr.m = m;
+    rr.a = a;
+    if (n == 0) {
+        rr.coeff.resize(m + 1);
+        rr.coeff.setConstant(std::numeric_limits<float>::quiet_NaN());
+        return rr;
+    }
+
+    Eigen::VectorXd filtered = Utb.array() * s.array() / (s.array().square() + a);
+    rr.coeff = (V * filtered).cast<float>();
+    return rr;
+}
+
+double RidgeRegressionPath::gcv(float a) const
+{
+    // In the SVD basis the residual and the trace of the hat matrix are both diagonal sums
+    Eigen::ArrayXd s2 = s.array().square();
+    Eigen::ArrayXd shrink = a / (s2 + a);
+    double residual = (shrink * Utb.array()).square().sum() + outside_norm2;
+    double dof = n - (s2 / (s2 + a)).sum();
+    if (dof <= 0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return n * residual / (dof * dof);
+}
+
+float RidgeRegressionPath::select_gcv(float a_min, float a_max, int num_steps) const
+{
+    float best_a = a_min;
+    double best_score = std::numeric_limits<double>::infinity();
+    double log_min = std::log(a_min);
+    double log_step = num_steps > 1 ? (std::log(a_max) - log_min) / (num_steps - 1) : 0;
+    for (int i = 0; i < num_steps; i++) {
+        float a = static_cast<float>(std::exp(log_min + i * log_step));
+        double score = gcv(a);
+        if (score < best_score) {
+            best_score = score;
+            best_a = a;
+        }
+    }
+    return best_a;
+}
+
+namespace
+{
+
+const double PI = 3.14159265358979323846;
+
+/// Evaluates a fit in the monomial basis over normalized x in double precision
+std::function<double(double)> monomial(Normalizer norm, const Vectorf& coeff)
+{
+    return [norm, coeff](double x) {
+        double t = (x - norm.mean_x) / norm.std_x;
+        double y = 0;
+        for (int k = static_cast<int>(coeff.size()) - 1; k >= 0; k--) {
+            y = y * t + coeff(k);
+        }
+        return y * norm.std_y + norm.mean_y;
+    };
+}
+
+} // namespace
+
+ChebyshevSeries::ChebyshevSeries(const std::function<double(double)>& f, int degree, float a,
+                                 float b)
+    : a{a}
+    , b{b}
+{
+    const int n = std::max(degree, 0) + 1;
+    std::vector<double> fs(n);
+    for (int j = 0; j < n; j++) {
+        double t = std::cos(PI * (j + 0.5) / n);
+        fs[j] = f(0.5 * (a + b) + 0.5 * (b - a) * t);
+    }
+
+    // the discrete cosine transform of the values at the nodes
+    coeff.resize(n);
+    for (int k = 0; k < n; k++) {
+        double c = 0;
+        for (int j = 0; j < n; j++) {
+            c += fs[j] * std::cos(PI * k * (j + 0.5) / n);
+        }
+        coeff[k] = 2.0 * c / n;
+    }
+    coeff[0] *= 0.5;
+}
+
+ChebyshevSeries::ChebyshevSeries(const MonomialInterpolation& solver, float a, float b)
+    : ChebyshevSeries(monomial(solver.norm, solver.coeff), solver.m, a, b)
+{
+}
+
+ChebyshevSeries::ChebyshevSeries(const NewtonInterpolation& solver, float a, float b)
+    : ChebyshevSeries([&](double x) { return solver.evaluate(x); }, solver.m - 1, a, b)
+{
+}
+
+template <typename Scalar>
+ChebyshevSeries::ChebyshevSeries(const BasicLeastSquare<Scalar>& solver, float a, float b)
+    : ChebyshevSeries(monomial(solver.norm, solver.coeff), solver.m, a, b)
+{
+}
+
+template ChebyshevSeries::ChebyshevSeries(const BasicLeastSquare<float>&, float, float);
+template ChebyshevSeries::ChebyshevSeries(const BasicLeastSquare<double>&, float, float);
+
+ChebyshevSeries::ChebyshevSeries(const OrthogonalLeastSquare& solver, float a, float b)
+    : ChebyshevSeries([&](double x) { return solver.evaluate(x); }, solver.m, a, b)
+{
+}
+
+template <typename Scalar>
+ChebyshevSeries::ChebyshevSeries(const BasicRidgeRegression<Scalar>& solver, float a, float b)
+    : ChebyshevSeries(monomial(solver.norm, solver.coeff), solver.m, a, b)
+{
+}
+
+template ChebyshevSeries::ChebyshevSeries(const BasicRidgeRegression<float>&, float, float);
+template ChebyshevSeries::ChebyshevSeries(const BasicRidgeRegression<double>&, float, float);
+
+int ChebyshevSeries::degree() const
+{
+    return static_cast<int>(coeff.size()) - 1;
+}
+
+float ChebyshevSeries::evaluate(float x) const
+{
+    double t = (2.0 * x - a - b) / (b - a);
+    double b1 = 0;
+    double b2 = 0;
+    for (int k = degree(); k >= 1; k--) {
+        double b0 = 2.0 * t * b1 - b2 + coeff[k];
+        b2 = b1;
+        b1 = b0;
+    }
+    double c0 = coeff.empty() ? 0.0 : coeff[0];
+    return static_cast<float>(t * b1 - b2 + c0);
+}
+
+std::vector<Point> ChebyshevSeries::predict(float x_start, float x_end, int num_points) const
+{
+    std::vector<Point> ret;
+    ret.resize(num_points);
+    predict(x_start, x_end, num_points, ret.data());
+    return ret;
+}
+
+void ChebyshevSeries::predict(float x_start, float x_end, int num_points, Point* out) const
+{
+    auto step = (x_end - x_start) / (num_points - 1);
     for (int i = 0; i < num_points; i++) {
-        ret[i].y = norm.denormalize_y(ys(i));
+        float x = x_start + i * step;
+        out[i] = {x, evaluate(x)};
+    }
+}
+
+ChebyshevSeries ChebyshevSeries::derivative() const
+{
+    ChebyshevSeries ret;
+    ret.a = a;
+    ret.b = b;
+
+    const int n = degree();
+    if (n < 1) {
+        ret.coeff.assign(1, 0.0);
+        return ret;
+    }
+
+    // c'_{k-1} = c'_{k+1} + 2k c_k, from the top down
+    ret.coeff.assign(n + 2, 0.0);
+    for (int k = n; k >= 1; k--) {
+        ret.coeff[k - 1] = ret.coeff[k + 1] + 2.0 * k * coeff[k];
+    }
+    ret.coeff[0] *= 0.5;
+    ret.coeff.resize(n);
+
+    const double scale = 2.0 / (b - a);
+    for (auto& c : ret.coeff) {
+        c *= scale;
+    }
+    return ret;
+}
+
+ChebyshevSeries ChebyshevSeries::integral() const
+{
+    ChebyshevSeries ret;
+    ret.a = a;
+    ret.b = b;
+
+    const int n = degree();
+    const double scale = 0.5 * (b - a);
+    ret.coeff.assign(n + 2, 0.0);
+    for (int k = 1; k <= n + 1; k++) {
+        double prev = k - 1 == 0 ? 2.0 * coeff[0] : coeff[k - 1];
+        double next = k + 1 <= n ? coeff[k + 1] : 0.0;
+        ret.coeff[k] = scale * (prev - next) / (2.0 * k);
+    }
+
+    // T_k(-1) = (-1)^k, pick the constant so that the value at a is zero
+    double at_a = 0;
+    for (int k = 1; k <= n + 1; k++) {
+        at_a += k % 2 ? -ret.coeff[k] : ret.coeff[k];
+    }
+    ret.coeff[0] = -at_a;
+    return ret;
+}
+
+std::vector<float> ChebyshevSeries::roots() const
+{
+    // trailing coefficients below the noise of the largest do not count towards the degree
+    double largest = 0;
+    for (auto c : coeff) {
+        largest = std::max(largest, std::abs(c));
     }
+    int n = degree();
+    while (n > 0 && std::abs(coeff[n]) <= 1e-13 * largest) {
+        n--;
+    }
+
+    std::vector<double> ts;
+    if (n == 1) {
+        double t = -coeff[0] / coeff[1];
+        if (std::abs(t) <= 1.0) {
+            ts.push_back(t);
+        }
+    }
+    else if (n > 1) {
+        // x T_0 = T_1, x T_k = (T_{k-1} + T_{k+1}) / 2 and T_n is eliminated by p(x) = 0
+        Eigen::MatrixXd C = Eigen::MatrixXd::Zero(n, n);
+        C(0, 1) = 1.0;
+        for (int i = 1; i < n; i++) {
+            C(i, i - 1) = 0.5;
+            if (i + 1 < n) {
+                C(i, i + 1) = 0.5;
+            }
+        }
+        for (int k = 0; k < n; k++) {
+            C(n - 1, k) -= coeff[k] / (2.0 * coeff[n]);
+        }
+
+        Eigen::EigenSolver<Eigen::MatrixXd> solver(C, false);
+        const auto& eig = solver.eigenvalues();
+        for (int i = 0; i < n; i++) {
+            if (std::abs(eig(i).imag()) < 1e-8 && std::abs(eig(i).real()) <= 1.0 + 1e-8) {
+                ts.push_back(std::max(-1.0, std::min(1.0, eig(i).real())));
+            }
+        }
+    }
+
+    std::vector<float> ret;
+    for (auto t : ts) {
+        ret.push_back(static_cast<float>(0.5 * (a + b) + 0.5 * (b - a) * t));
+    }
+    std::sort(ret.begin(), ret.end());
     return ret;
 }
+
+std::vector<float> ChebyshevSeries::extrema() const
+{
+    return derivative().roots();
+}
@@ -1,27 +1,24 @@
 #pragma once
 
-#include "gui.hpp"
+#include "normalizer.hpp"
+#include "point.hpp"
+#include "point_set.hpp"
+#include "thread_pool.hpp"
 
 #include "Eigen/Core"
 
+#include <cstddef>
+#include <functional>
+#include <vector>
+
 using Matrixf = Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic>;
 using Vectorf = Eigen::Matrix<float, Eigen::Dynamic, 1>;
 
-struct Normalizer
-{
-    float mean_x;
-    float mean_y;
-    float std_x;
-    float std_y;
-    Normalizer() {}
-    Normalizer(const std::vector<Point>& points);
-
-    float normalize_x(float x);
-    float normalize_y(float y);
-
-    float denormalize_x(float x);
-    float denormalize_y(float y);
-};
+/// Evaluates y = sum_k coeff[k] * t^k with t = norm.normalize_x(x) by Horner's scheme on num_points
+/// equally spaced x in [x_start, x_end] and writes the denormalized curve into out. The samples
+/// are processed in SIMD lanes and nothing is allocated.
+void predict_polynomial(const Normalizer& norm, const float* coeff, int num_coeff, float x_start,
+                        float x_end, int num_points, Point* out);
 
 struct MonomialInterpolation
 {
@@ -31,36 +28,379 @@ struct MonomialInterpolation
     MonomialInterpolation() {}
     MonomialInterpolation(const std::vector<Point>& points);
     std::vector<Point> predict(float x_start, float x_end, int num_points);
+    void predict(float x_start, float x_end, int num_points, Point* out);
+};
+
+/// Polynomial interpolation in Newton form. The divided differences are updated in place, appending
+/// or removing the last point costs O(n) and removing any other point costs O(n^2).
+struct NewtonInterpolation
+{
+    int m{0};                  // number of interpolated points
+    std::vector<double> xs;    // the nodes, in insertion order
+    std::vector<double> ys;    // the values at the nodes
+    std::vector<double> coeff; // coeff[k] = f[x_0, ..., x_k]
+    std::vector<double> last;  // last[k] = f[x_{m-1-k}, ..., x_{m-1}], the bottom diagonal
+    NewtonInterpolation() {}
+    NewtonInterpolation(const std::vector<Point>& points);
+
+    void add_point(const Point& p);
+    void remove_point(int i);
+    void clear();
+
+    float evaluate(float x) const;
+    std::vector<Point> predict(float x_start, float x_end, int num_points) const;
+};
+
+/// Polynomial interpolation in the second (true) barycentric form. The weights are only needed up
+/// to a common factor, which cancels on evaluation, so they are tracked as logarithms and
+/// exponentiated relative to the largest one to stay in range.
+struct BarycentricInterpolation
+{
+    int m{0};                  // number of interpolated points
+    std::vector<double> xs;    // the nodes
+    std::vector<double> ys;    // the values at the nodes
+    std::vector<double> log_ws; // log|w_j|, w_j = 1 / prod_{k != j} (x_j - x_k)
+    std::vector<double> signs;  // sign of w_j
+    std::vector<double> ws;     // w_j divided by the largest |w_k|
+    BarycentricInterpolation() {}
+    BarycentricInterpolation(const std::vector<Point>& points);
+
+    void add_point(const Point& p);
+    void remove_point(int i);
+    void clear();
+
+    float evaluate(float x) const;
+    std::vector<Point> predict(float x_start, float x_end, int num_points);
+
+private:
+    void rescale();
+};
+
+/// Controls the matrix-free solve of GaussInterpolation
+struct IterativeOptions
+{
+    float tol{1e-4f};   // stop once ||r|| <= tol * ||b||
+    int max_iter{500};  // the iteration cap
+    int block_size{32}; // number of neighbouring points per block of the Jacobi preconditioner
 };
 
 struct GaussInterpolation
 {
-    int m;         // number of Gauss basis
-    float sigma;   // the global standard deviation
-    Vectorf coeff; // the solved coefficient
-    Vectorf xs;    // the original xs that form the basis functions
+    int m;             // number of Gauss basis
+    float sigma;       // the global standard deviation
+    Vectorf coeff;     // the solved coefficient
+    Vectorf xs;        // the original xs that form the basis functions
+    int iterations{0}; // iterations taken by both matrix-free solves
+    float residual{0}; // the larger relative residual of the matrix-free solves
     GaussInterpolation() {}
     GaussInterpolation(float sigma, const std::vector<Point>& points);
+
+    /// Solves from the ys of the set in place and takes the closest pair from it instead of
+    /// sorting. The xs are copied, the prediction needs them after the set has changed.
+    GaussInterpolation(float sigma, const PointSet& points);
+
+    /// Solves the same system as the dense path by preconditioned conjugate gradient without ever
+    /// forming it. The constant term and the mid-point equation are eliminated through a scalar
+    /// Schur complement, which takes two solves with the symmetric positive definite kernel
+    /// matrix. Memory is O(n * block_size).
+    GaussInterpolation(float sigma, const std::vector<Point>& points, const IterativeOptions& opts);
+    float evaluate(float x) const;
     std::vector<Point> predict(float x_start, float x_end, int num_points);
+
+    /// Sums only the centers close enough to each sample that the dropped terms stay below
+    /// max_error, sliding a window over the sorted centers, O(num_points + m) for ascending
+    /// samples. If exact_error is given the exact path runs as well and the largest deviation
+    /// from it is written there.
+    std::vector<Point> predict_truncated(float x_start, float x_end, int num_points,
+                                         float max_error, float* exact_error = nullptr);
+
+private:
+    /// solves the kernel system over xs, with (mid_x, mid_y) as the extra equation
+    void solve(const Eigen::Ref<const Vectorf>& ys, float mid_x, float mid_y);
+    void sort_centers();
+    Vectorf sorted_xs;    // xs in ascending order
+    Vectorf sorted_coeff; // the Gauss coefficients, in the order of sorted_xs
 };
 
-struct LeastSquare
+/// Interpolation with the compactly supported Wendland C2 kernel
+/// phi(r) = (1 - r)^4 (4r + 1), r = |x - x_i| / sigma, which vanishes beyond sigma. The kernel
+/// matrix is sparse and positive definite, so it is assembled by a sweep over the sorted xs and
+/// factored with a sparse LDL^T Cholesky. The mean of the ys stands in for the constant term.
+struct WendlandInterpolation
 {
+    int m{0};        // number of Wendland basis
+    float sigma{0};  // the support radius
+    float mean_y{0}; // subtracted from the ys before solving
+    Vectorf coeff;   // the solved coefficient, one per entry of xs
+    Vectorf xs;      // the sorted xs that form the basis functions
+    WendlandInterpolation() {}
+    WendlandInterpolation(float sigma, const std::vector<Point>& points);
+    float evaluate(float x) const;
+    std::vector<Point> predict(float x_start, float x_end, int num_points);
+};
+
+/// Produces the points of a data set chunk by chunk, so that it never has to be in memory at once
+struct PointSource
+{
+    virtual ~PointSource(){};
+    /// copies up to capacity points into buf, returns how many, 0 once exhausted
+    virtual size_t fill(Point* buf, size_t capacity) = 0;
+    /// starts over from the first point
+    virtual void rewind() = 0;
+};
+
+template <typename It>
+struct IteratorPointSource : public PointSource
+{
+    It first;
+    It last;
+    It cur;
+
+    IteratorPointSource(It first, It last)
+        : first{first}
+        , last{last}
+        , cur{first}
+    {
+    }
+    ~IteratorPointSource() override{};
+
+    size_t fill(Point* buf, size_t capacity) override
+    {
+        size_t n = 0;
+        for (; n < capacity && cur != last; ++n, ++cur) {
+            buf[n] = *cur;
+        }
+        return n;
+    }
+
+    void rewind() override
+    {
+        cur = first;
+    }
+};
+
+/// Mean and sum of squared deviations of both coordinates, merged pairwise with Chan's update so
+/// that partial results from different chunks can be combined.
+struct PointStats
+{
+    double count{0};
+    double mean_x{0};
+    double mean_y{0};
+    double m2_x{0};
+    double m2_y{0};
+
+    void add(const Point& p);
+    void merge(const PointStats& other);
+    Normalizer normalizer() const;
+};
+
+/// The normal equations of a least square polynomial fit of order m, kept as running sums so the
+/// design matrix is never formed. A^T A is a Hankel matrix of the power sums of the normalized x,
+/// so only 2m + 1 of them are stored next to the m + 1 entries of A^T b.
+struct NormalEquations
+{
+    int m;
     Normalizer norm;
-    int m;         // the highest order of the basis function
+    Eigen::VectorXd x_powers;  // sum_i x_i^k for k = 0 .. 2m
+    Eigen::VectorXd xy_powers; // sum_i x_i^k y_i for k = 0 .. m
+    NormalEquations() {}
+    NormalEquations(int m, const Normalizer& norm);
+
+    void accumulate(const Point* points, size_t n);
+    /// the same from separate arrays of the coordinates
+    void accumulate(const float* xs, const float* ys, size_t n);
+    void accumulate(const double* xs, const double* ys, size_t n);
+    void merge(const NormalEquations& other);
+    /// the coefficients, with the ridge weight a added to the diagonal
+    Vectorf solve(float a = 0) const;
+};
+
+struct StreamOptions
+{
+    int num_threads{0};         // 0 to use every hardware thread
+    size_t chunk_size{1 << 16}; // points per chunk handed to a thread
+    /// runs the chunks, such as a pool kept across fits, one of num_threads workers is made for
+    /// the fit if null. It must not be the pool the fit itself runs on, whose workers would then
+    /// wait on each other.
+    ThreadPool* pool{nullptr};
+};
+
+/// Sums the normal equations of order m over separate x and y arrays in place, such as the views
+/// of a MappedPointFile, with one contiguous range of the arrays per task of the pool. Instantiated
+/// for float and double.
+template <typename Scalar>
+NormalEquations accumulate_columns(int m, const Normalizer& norm, const Scalar* xs,
+                                   const Scalar* ys, size_t n, const StreamOptions& opts);
+
+/// Orders up to this one are solved with fixed-size matrices on the stack
+constexpr int MAX_FIXED_ORDER = 15;
+
+/// Fits a polynomial of order m to the normalized points by the ridge normal equations
+/// (A^T A + a I) c = A^T b, accumulated as power sums in Scalar precision. Orders up to
+/// MAX_FIXED_ORDER dispatch to instantiations of fixed size, higher ones take the dynamic path.
+/// Instantiated for float and double.
+template <typename Scalar>
+Vectorf fit_polynomial(int m, float a, const std::vector<Point>& points, const Normalizer& norm);
+
+/// Least square polynomial fit whose normal equations are summed and solved in Scalar precision
+/// when fitted to a vector of points. The streamed and array constructors sum in double for either
+/// Scalar, as float power sums over millions of points keep no significant digit. Instantiated for
+/// float and double, LeastSquare is the double one.
+template <typename Scalar>
+struct BasicLeastSquare
+{
+    Normalizer norm;
+    int m{0};      // the highest order of the basis function
     Vectorf coeff; // the solved coefficient
-    LeastSquare() {}
-    LeastSquare(int m, const std::vector<Point>& points);
+    BasicLeastSquare() {}
+    BasicLeastSquare(int m, const std::vector<Point>& points);
+
+    /// Fits in two passes over the source, one for the normalizer and one for the normal
+    /// equations. The calling thread fills one set of chunks while the pool sums the other into
+    /// partial sums, memory is O(m^2) on top of two chunks per thread.
+    BasicLeastSquare(int m, PointSource& source, const StreamOptions& opts = {});
+
+    template <typename It>
+    BasicLeastSquare(int m, It first, It last, const StreamOptions& opts = {})
+    {
+        IteratorPointSource<It> source{first, last};
+        *this = BasicLeastSquare(m, source, opts);
+    }
+
+    /// Fits in a single pass over separate x and y arrays, which are read in place. norm has to
+    /// be known up front, such as the one stored in a point file.
+    BasicLeastSquare(int m, const Eigen::Ref<const Eigen::VectorXf>& xs,
+                     const Eigen::Ref<const Eigen::VectorXf>& ys, const Normalizer& norm,
+                     const StreamOptions& opts = {});
+    BasicLeastSquare(int m, const Eigen::Ref<const Eigen::VectorXd>& xs,
+                     const Eigen::Ref<const Eigen::VectorXd>& ys, const Normalizer& norm,
+                     const StreamOptions& opts = {});
+
     std::vector<Point> predict(float x_start, float x_end, int num_points);
+    void predict(float x_start, float x_end, int num_points, Point* out);
 };
 
-struct RidgeRegression
+using LeastSquare = BasicLeastSquare<double>;
+
+/// Least square fit in the basis of polynomials orthogonal over the data, generated by Forsythe's
+/// three-term recurrence p_{k+1} = (x - alpha_k) p_k - beta_k p_{k-1}. Each coefficient is a plain
+/// projection, so raising the order by one costs O(n) and keeps every lower coefficient, and the
+/// leave-one-out error of every order falls out of the running residual and leverages.
+struct OrthogonalLeastSquare
 {
     Normalizer norm;
-    int m;
-    float a; // the weighting term of normalization
+    int m{-1};                 // the order in use, at most fitted_order()
+    std::vector<double> alpha; // alpha[k] and beta[k] produce p_{k+1}
+    std::vector<double> beta;
+    std::vector<double> coeff; // coeff[k] = <y, p_k> / <p_k, p_k>
+    std::vector<double> loocv; // leave-one-out cross validation score of each fitted order
+    OrthogonalLeastSquare() {}
+    OrthogonalLeastSquare(int m, const std::vector<Point>& points);
+
+    int fitted_order() const;
+    /// fits one more order, false once the basis is exhausted by the number of distinct xs
+    bool raise_order();
+    /// fits up to order m if needed and uses it for prediction
+    void set_order(int m);
+    /// fits up to max_order and returns the order with the lowest leave-one-out score
+    int best_order(int max_order);
+
+    float evaluate(float x) const;
+    std::vector<Point> predict(float x_start, float x_end, int num_points);
+    void predict(float x_start, float x_end, int num_points, Point* out);
+
+private:
+    std::vector<double> xs;       // the normalized xs
+    std::vector<double> ys;       // the normalized ys
+    std::vector<double> p_prev;   // p_{k-1} at the xs
+    std::vector<double> p_cur;    // p_k at the xs
+    std::vector<double> norms;    // norms[k] = <p_k, p_k>
+    std::vector<double> residual; // y - fit of the highest fitted order
+    std::vector<double> leverage; // diagonal of the hat matrix of the highest fitted order
+    void push_order();
+};
+
+/// Ridge regression in Scalar precision, as BasicLeastSquare. RidgeRegression is the double one.
+template <typename Scalar>
+struct BasicRidgeRegression
+{
+    Normalizer norm;
+    int m{0};
+    float a{0}; // the weighting term of normalization
     Vectorf coeff;
-    RidgeRegression() {}
-    RidgeRegression(int m, float a, const std::vector<Point>& points);
+    BasicRidgeRegression() {}
+    BasicRidgeRegression(int m, float a, const std::vector<Point>& points);
+
+    /// as the array constructors of LeastSquare
+    BasicRidgeRegression(int m, float a, const Eigen::Ref<const Eigen::VectorXf>& xs,
+                         const Eigen::Ref<const Eigen::VectorXf>& ys, const Normalizer& norm,
+                         const StreamOptions& opts = {});
+    BasicRidgeRegression(int m, float a, const Eigen::Ref<const Eigen::VectorXd>& xs,
+                         const Eigen::Ref<const Eigen::VectorXd>& ys, const Normalizer& norm,
+                         const StreamOptions& opts = {});
+    float evaluate(float x) const;
     std::vector<Point> predict(float x_start, float x_end, int num_points);
+    void predict(float x_start, float x_end, int num_points, Point* out);
+};
+
+using RidgeRegression = BasicRidgeRegression<double>;
+
+/// Caches a thin SVD A = U S V^T of the normalized design matrix, after which the ridge solution
+/// c(a) = V diag(s / (s^2 + a)) U^T b costs O(m^2) for any weight a, with no refactorization.
+struct RidgeRegressionPath
+{
+    Normalizer norm;
+    int m{0};
+    int n{0};                // number of points
+    Eigen::VectorXd s;       // the singular values
+    Eigen::MatrixXd V;       // the right singular vectors
+    Eigen::VectorXd Utb;     // U^T b
+    double outside_norm2{0}; // ||b||^2 - ||U^T b||^2, the part of b no weight can fit
+    RidgeRegressionPath() {}
+    RidgeRegressionPath(int m, const std::vector<Point>& points);
+
+    RidgeRegression solve(float a) const;
+
+    /// generalized cross validation score n ||b - A c(a)||^2 / (n - tr H(a))^2
+    double gcv(float a) const;
+
+    /// the weight with the lowest GCV score among num_steps log-spaced values in [a_min, a_max]
+    float select_gcv(float a_min, float a_max, int num_steps = 64) const;
+};
+
+/// A polynomial p(x) = sum_k coeff[k] T_k(t) in the Chebyshev basis over [a, b], with
+/// t = (2x - a - b) / (b - a). It is evaluated by Clenshaw's recurrence, which stays accurate at
+/// high order where the monomial basis does not, and differentiated, integrated and solved for
+/// roots without going back to the points.
+struct ChebyshevSeries
+{
+    float a{-1};               // the interval the series is built on
+    float b{1};
+    std::vector<double> coeff; // coeff[k] multiplies T_k
+    ChebyshevSeries() {}
+
+    /// Interpolates f at the degree + 1 Chebyshev points of [a, b], exact for any polynomial f of
+    /// at most that degree
+    ChebyshevSeries(const std::function<double(double)>& f, int degree, float a, float b);
+
+    ChebyshevSeries(const MonomialInterpolation& solver, float a, float b);
+    ChebyshevSeries(const NewtonInterpolation& solver, float a, float b);
+    template <typename Scalar>
+    ChebyshevSeries(const BasicLeastSquare<Scalar>& solver, float a, float b);
+    ChebyshevSeries(const OrthogonalLeastSquare& solver, float a, float b);
+    template <typename Scalar>
+    ChebyshevSeries(const BasicRidgeRegression<Scalar>& solver, float a, float b);
+
+    int degree() const;
+    float evaluate(float x) const;
+    std::vector<Point> predict(float x_start, float x_end, int num_points) const;
+    void predict(float x_start, float x_end, int num_points, Point* out) const;
+
+    ChebyshevSeries derivative() const;
+    /// the antiderivative that vanishes at a
+    ChebyshevSeries integral() const;
+    /// the real roots in [a, b] in ascending order, from the eigenvalues of the colleague matrix
+    std::vector<float> roots() const;
+    /// the roots of the derivative
+    std::vector<float> extrema() const;
 };
@@ -0,0 +1,15 @@
+#pragma once
+
+// The GLFW window and the OpenGL 3 renderer the GUI runs in. gui.hpp only needs ImGui, so that the
+// GUI also runs headless.
+
+#define IMGUI_IMPL_OPENGL_LOADER_GLBINDING3
+#include <imgui.h>
+#include <imgui_impl_glfw.h>
+#include <imgui_impl_opengl3.h>
+
+#define GLFW_INCLUDE_NONE 1
+#include <glbinding/gl/gl.h>
+#include <glbinding/glbinding.h>
+
+#include <GLFW/glfw3.h>
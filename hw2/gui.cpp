@@ -1,9 +1,18 @@
 #include "gui.hpp"
 #include "solve.hpp"
+#include "adaptive_sampling.hpp"
+#include "async_result.hpp"
+#include "curve_renderer.hpp"
+#include "point_file.hpp"
+#include "point_list_box.hpp"
+#include "point_markers.hpp"
+#include "profiler_window.hpp"
+#include "thread_pool.hpp"
+#include "tile_cache.hpp"
 
 #include <algorithm>
 #include <iostream>
-#include <sstream>
+#include <memory>
 #include <vector>
 
 using namespace std;
@@ -16,83 +25,94 @@ struct Vec2
 
 struct GuiData
 {
-    vector<Point> points;
-    string points_str{};
-    int selected{0};
-    vector<char*> points_str_view{};
+    PointList points;
+    uint32_t selected{PointList::NO_ID};
     bool points_changed{false};
     Vec2 scrolling{0.f, 0.f};
     bool opt_enable_grid{true};
     bool opt_enable_context_menu{true};
     bool deleting_guard{false};
+    char open_path[260]{}; // of the point file to open
+    string open_error;     // why the last open failed
+
+    struct Result
+    {
+        RBFNetwork solver;
+        vector<Point> points;
+        bool fitted{false};
+        uint64_t model_version{0}; // bumped by every fit or change of the sampling
+        TileCache<vector<Point>> tiles;
+    };
 
     struct
     {
         int num_basis{4};
         int num_points{150};
-        // std::shared_ptr<Optimizer> opt{new SgdOptimizer(0.1)};
-        std::shared_ptr<Optimizer> opt{new AdamOptimizer(0.1)};
-        RBFNetwork solver{num_basis};
+        int predicted_points{-1};
+        float predicted_x_start{0};
+        float predicted_x_end{0};
+        bool adaptive{false};          // sample by sample_adaptive instead of num_points
+        AdaptiveOptions adaptive_opts; // its tolerance is in pixels
+        float predicted_tolerance{-1}; // negative for uniform samples
+        AsyncResult<Result> result;    // fitted and predicted in the background
+        uint64_t fit_version{0};       // the job of the last requested fit
+        uint64_t stale_version{0};     // the last job that made the cached tiles stale
         bool enabled{true};
         bool fit{false};
         bool predict{false};
-        vector<Point> points;
+        bool resample{false}; // predict anew instead of from the cached tiles
     } rbf;
 };
 
 GuiData gui_data{};
+ThreadPool thread_pool{1}; // a single model, jobs of one AsyncResult never run at once anyway
+CurveRenderer curve_renderer{};
 
-void GuiOnPointsChanged()
+JobState GuiJobs()
 {
-    if (!gui_data.points_changed)
-        return;
-
-    gui_data.points_str.clear();
-    gui_data.points_str_view.clear();
-
-    if (gui_data.points.size() == 0)
-        return;
-
-    ostringstream oss{};
-    auto beg = oss.tellp();
-
-    gui_data.points_str_view.reserve(gui_data.points.size());
-    for (const auto& p : gui_data.points) {
-        gui_data.points_str_view.push_back(reinterpret_cast<char*>(oss.tellp() - beg));
-        oss << "x: " << p.x << ", "
-            << "y:" << p.y;
-        oss.put(0);
-    }
-    gui_data.points_str = oss.str();
+    return {gui_data.rbf.result.busy(), gui_data.rbf.result.published()};
+}
 
-    for (auto& ptr : gui_data.points_str_view) {
-        ptr = gui_data.points_str.data() + reinterpret_cast<ptrdiff_t>(ptr);
+bool OpenPointFile(const string& path, string& error)
+{
+    MappedPointFile file;
+    if (!file.open(path, error)) {
+        return false;
     }
+    vector<Point> points;
+    file.copy_to(points);
+    gui_data.points.assign(std::move(points));
+    gui_data.selected = PointList::NO_ID;
+    gui_data.points_changed = true;
+    error.clear();
+    return true;
 }
 
 void DrawImGUI()
 {
-    ImGui_ImplOpenGL3_NewFrame();
-    ImGui_ImplGlfw_NewFrame();
+    PROFILE_SCOPE("DrawImGUI");
     ImGui::NewFrame();
 
     if (ImGui::IsKeyReleased(ImGui::GetKeyIndex(ImGuiKey_Delete))) {
         gui_data.deleting_guard = false;
     }
 
-    if (gui_data.selected >= gui_data.points.size()) {
-        gui_data.selected = gui_data.points.size() - 1;
+    if (gui_data.points.index(gui_data.selected) == PointList::NONE && !gui_data.points.empty()) {
+        gui_data.selected = gui_data.points.id(0);
     }
 
-    if (!gui_data.deleting_guard && gui_data.points.size() > 0 &&
+    const size_t selected = gui_data.points.index(gui_data.selected);
+    if (!gui_data.deleting_guard && selected != PointList::NONE &&
         ImGui::IsKeyPressed(ImGui::GetKeyIndex(ImGuiKey_Delete))) {
-        gui_data.points.erase(gui_data.points.begin() + gui_data.selected);
+        // the last point moves into the gap and is selected next
+        gui_data.points.remove(selected);
+        if (!gui_data.points.empty())
+            gui_data.selected = gui_data.points.id(std::min(selected, gui_data.points.size() - 1));
         gui_data.points_changed = true;
         gui_data.deleting_guard = true;
     }
 
     if (gui_data.points_changed) {
-        GuiOnPointsChanged();
         if (gui_data.points.size() > 0) {
             gui_data.rbf.fit = true;
         }
@@ -100,9 +120,16 @@ void DrawImGUI()
     }
 
     if (ImGui::Begin("Points")) {
-        ImGui::ListBox("##1", &gui_data.selected, gui_data.points_str_view.data(),
-                       gui_data.points_str_view.size(),
-                       std::min<int>(30, gui_data.points_str_view.size()));
+        ImGui::InputText("##path", gui_data.open_path, sizeof(gui_data.open_path));
+        ImGui::SameLine();
+        if (ImGui::Button("Open")) {
+            OpenPointFile(gui_data.open_path, gui_data.open_error);
+        }
+        if (!gui_data.open_error.empty()) {
+            ImGui::TextColored({1.f, 0.4f, 0.4f, 1.f}, "%s", gui_data.open_error.c_str());
+        }
+        PROFILE_SCOPE("PointListBox");
+        PointListBox("##1", gui_data.points, gui_data.selected);
     }
     ImGui::End();
 
@@ -120,8 +147,25 @@ void DrawImGUI()
         ImGui::InputInt("Points##1", &gui_data.rbf.num_points, 1, 10);
         ImGui::SameLine();
         ImGui::InputInt("Number of Basis##1", &gui_data.rbf.num_basis, 1, 10);
+        ImGui::SameLine();
+        ImGui::Checkbox("Adaptive##1", &gui_data.rbf.adaptive);
+        if (gui_data.rbf.adaptive) {
+            ImGui::SameLine();
+            ImGui::InputFloat("Tolerance (px)##1", &gui_data.rbf.adaptive_opts.tolerance, 0.05,
+                              0.5);
+        }
         ImGui::EndGroup();
 
+        // as of the last frame, the curves of this one are drawn below
+        const auto& drawn = curve_renderer.draw_stats();
+        ImGui::Text("Curve: %d of %d points drawn, %d vertices, %d indices in %.3f ms",
+                    drawn.drawn_points, drawn.input_points, drawn.vertices, drawn.indices,
+                    drawn.build_ms);
+        auto rbf_error = gui_data.rbf.result.error();
+        if (!rbf_error.empty()) {
+            ImGui::TextColored({1.f, 0.4f, 0.4f, 1.f}, "RBF Network failed: %s", rbf_error.c_str());
+        }
+
         ImGui::Text("Mouse Right: drag to scroll, click for context menu.");
 
         if (gui_data.rbf.enabled) {
@@ -130,14 +174,15 @@ void DrawImGUI()
             if (rbf.num_points < 2)
                 rbf.num_points = 2;
 
-            if (rbf.num_points != rbf.points.size())
-                rbf.predict = true;
+            if (rbf.adaptive_opts.tolerance < 0.01f)
+                rbf.adaptive_opts.tolerance = 0.01f;
 
-            if (rbf.fit) {
-                rbf.solver.fit(rbf.opt, gui_data.points);
-                rbf.fit = false;
+            float tolerance = rbf.adaptive ? rbf.adaptive_opts.tolerance : -1;
+            if (tolerance != rbf.predicted_tolerance)
+                rbf.resample = true;
+
+            if (rbf.num_points != rbf.predicted_points)
                 rbf.predict = true;
-            }
         }
 
         // Using InvisibleButton() as a convenience 1) it will advance the layout cursor and 2)
@@ -166,7 +211,7 @@ void DrawImGUI()
 
         // Add first and second point
         if (is_hovered && ImGui::IsMouseClicked(ImGuiMouseButton_Left)) {
-            gui_data.points.push_back(mouse_pos_in_canvas);
+            gui_data.points.add(mouse_pos_in_canvas);
             gui_data.points_changed = true;
         }
 
@@ -192,7 +237,72 @@ void DrawImGUI()
             ImGui::EndPopup();
         }
 
+        // The fit runs in the background on a snapshot of the points, a newer one cancels it and
+        // the last complete curve is drawn until then. Only the visible part of the canvas is
+        // predicted, from tiles that are kept until the next fit.
+        if (gui_data.rbf.enabled) {
+            auto& rbf = gui_data.rbf;
+            const float view_x0 = -gui_data.scrolling.x;
+            const float view_x1 = view_x0 + canvas_sz.x;
+            if (view_x0 != rbf.predicted_x_start || view_x1 != rbf.predicted_x_end)
+                rbf.predict = true;
+
+            if (rbf.fit || rbf.predict || rbf.resample) {
+                // a prediction alone would cancel a fit still running, so that fit goes along, and
+                // likewise a job that would have made the tiles stale
+                bool fit = rbf.fit || rbf.result.published() < rbf.fit_version;
+                bool stale = fit || rbf.resample || rbf.result.published() < rbf.stale_version;
+                auto job = [fit, stale, points = gui_data.points.snapshot(),
+                            num_basis = rbf.num_basis, num_points = rbf.num_points,
+                            adaptive = rbf.adaptive,
+                            opts = rbf.adaptive_opts, x_start = view_x0, x_end = view_x1](
+                               GuiData::Result& r, const Cancelled& cancelled) {
+                    if (fit) {
+                        // std::shared_ptr<Optimizer> opt{new SgdOptimizer(0.1)};
+                        std::shared_ptr<Optimizer> opt{new AdamOptimizer(0.1)};
+                        r.solver = RBFNetwork(num_basis);
+                        r.solver.fit(opt, *points, cancelled);
+                        r.fitted = true;
+                        if (cancelled())
+                            return false;
+                    }
+                    if (!r.fitted)
+                        return false;
+                    if (stale)
+                        r.model_version++;
+
+                    // in a tile the adaptive sampling starts from one segment per 8 sample spacings
+                    AdaptiveOptions tile_opts = opts;
+                    tile_opts.initial_segments = TILE_SAMPLES / 8;
+                    auto predict_tile = [&](float x0, float x1, int n, vector<Point>& tile) {
+                        if (adaptive)
+                            sample_adaptive([&](float x) { return r.solver.evaluate(x); }, x0, x1,
+                                            tile_opts, tile);
+                        else
+                            tile = r.solver.predict(x0, x1, n);
+                    };
+                    predict_tiled(r.tiles, r.model_version, tile_level(x_end - x_start, num_points),
+                                  x_start, x_end, predict_tile, r.points);
+                    return true;
+                };
+                auto version = rbf.result.submit(thread_pool, job);
+                if (fit)
+                    rbf.fit_version = version;
+                if (stale)
+                    rbf.stale_version = version;
+                rbf.fit = false;
+                rbf.predict = false;
+                rbf.resample = false;
+                rbf.predicted_points = rbf.num_points;
+                rbf.predicted_tolerance = rbf.adaptive ? rbf.adaptive_opts.tolerance : -1;
+                rbf.predicted_x_start = view_x0;
+                rbf.predicted_x_end = view_x1;
+            }
+        }
+
         // Draw grid + all lines in the canvas
+        PROFILE_SCOPE("ImDrawList");
+        curve_renderer.reset_stats();
         draw_list->PushClipRect(canvas_p0, canvas_p1, true);
         if (gui_data.opt_enable_grid) {
             const float GRID_STEP = 64.0f;
@@ -204,38 +314,23 @@ void DrawImGUI()
                                    IM_COL32(200, 200, 200, 40));
         }
 
-        if (gui_data.points.size()) {
-            draw_list->AddCircleFilled(
-                {origin.x + gui_data.points[0].x, origin.y + gui_data.points[0].y}, 4,
-                IM_COL32(255, 100, 100, 255));
-        }
+        const auto& marked = gui_data.points.points();
+        const ImU32 point_color = IM_COL32(255, 100, 100, 255);
+        draw_point_markers(draw_list, origin, marked, 0, 1, 4, point_color);
 
         if (gui_data.rbf.enabled) {
-            auto& rbf = gui_data.rbf;
-            if (rbf.predict) {
-                rbf.points = rbf.solver.predict(0, canvas_sz.x, rbf.num_points);
-                rbf.predict = false;
-            }
-            const auto& xy = rbf.points;
-            for (int n = 1; n < xy.size(); n++) {
-                draw_list->AddLine({origin.x + xy[n - 1].x, origin.y + xy[n - 1].y},
-                                   {origin.x + xy[n].x, origin.y + xy[n].y},
-                                   IM_COL32(128, 255, 255, 255), 2.0f);
-            }
+            auto result = gui_data.rbf.result.get();
+            curve_renderer.draw(draw_list, origin, result->points, IM_COL32(128, 255, 255, 255));
         }
 
 
-        for (int n = 1; n < gui_data.points.size(); n++) {
-            draw_list->AddCircleFilled(
-                {origin.x + gui_data.points[n].x, origin.y + gui_data.points[n].y}, 5,
-                IM_COL32(255, 100, 100, 255));
-        }
+        draw_point_markers(draw_list, origin, marked, 1, marked.size(), 5, point_color);
         draw_list->PopClipRect();
     }
 
     ImGui::End();
 
-    ImGui::Render();
+    DrawProfilerWindow();
 
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    ImGui::Render();
 }
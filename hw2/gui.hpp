@@ -1,21 +1,19 @@
 #pragma once
 
-#define IMGUI_IMPL_OPENGL_LOADER_GLBINDING3
-#define GLFW_INCLUDE_NONE 1
 #include <imgui.h>
 
-#include <imgui_impl_glfw.h>
-#include <imgui_impl_opengl3.h>
+#include "point.hpp"
+#include "redraw_tracker.hpp"
 
-#include <glbinding/gl/gl.h>
-#include <glbinding/glbinding.h>
+#include <string>
 
-#include <GLFW/glfw3.h>
+/// Builds a frame, from ImGui::NewFrame() to ImGui::Render(). The NewFrame() of the backends comes
+/// before and rendering the draw data after, both up to the caller.
+void DrawImGUI();
 
-struct Point
-{
-    float x;
-    float y;
-};
+/// the state of the background jobs whose results the canvas shows
+JobState GuiJobs();
 
-void DrawImGUI();
+/// Replaces the points by those of a binary point file, as written by curvefit --pack. Returns
+/// false and sets error on failure.
+bool OpenPointFile(const std::string& path, std::string& error);
@@ -1,4 +1,6 @@
 #include "gui.hpp"
+#include "profiler.hpp"
+#include "window.hpp"
 
 #include <iostream>
 #include <sstream>
@@ -12,7 +14,41 @@ void GlfwErrorCallback(int error, const char* description)
     cerr << "GLFW Error" << error << ": " << description << endl;
 }
 
-int main()
+/// Seconds until ImGui needs another frame without further input: none while a key or a mouse
+/// button is held, whose repeats ImGui generates itself, and a blink step while a text field has
+/// the cursor
+double ImGuiFrameDelay()
+{
+    const ImGuiIO& io = ImGui::GetIO();
+    if (ImGui::IsAnyMouseDown()) {
+        return 0;
+    }
+    for (bool down : io.KeysDown) {
+        if (down) {
+            return 0;
+        }
+    }
+    return io.WantTextInput ? 0.1 : RedrawTracker::NEVER;
+}
+
+/// Marks a frame as due on every event of the window. The input callbacks are installed before
+/// ImGui's, which chain to them.
+void InstallRedrawCallbacks(GLFWwindow* window)
+{
+    glfwSetMouseButtonCallback(window,
+                               [](GLFWwindow*, int, int, int) { redraw_tracker().input(); });
+    glfwSetScrollCallback(window, [](GLFWwindow*, double, double) { redraw_tracker().input(); });
+    glfwSetKeyCallback(window, [](GLFWwindow*, int, int, int, int) { redraw_tracker().input(); });
+    glfwSetCharCallback(window, [](GLFWwindow*, unsigned int) { redraw_tracker().input(); });
+    glfwSetCursorPosCallback(window, [](GLFWwindow*, double, double) { redraw_tracker().input(); });
+    glfwSetCursorEnterCallback(window, [](GLFWwindow*, int) { redraw_tracker().input(); });
+    glfwSetWindowFocusCallback(window, [](GLFWwindow*, int) { redraw_tracker().input(); });
+    glfwSetWindowRefreshCallback(window, [](GLFWwindow*) { redraw_tracker().input(); });
+    glfwSetFramebufferSizeCallback(window,
+                                   [](GLFWwindow*, int, int) { redraw_tracker().input(); });
+}
+
+int main(int argc, char** argv)
 {
     glfwSetErrorCallback(GlfwErrorCallback);
     if (!glfwInit()) {
@@ -44,13 +80,31 @@ int main()
 
     ImGui::StyleColorsDark();
 
+    InstallRedrawCallbacks(window);
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init(glsl_version);
 
     ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
 
+    string error;
+    if (argc > 1 && !OpenPointFile(argv[1], error)) {
+        cerr << error << endl;
+    }
+
+    // frames are drawn on demand, between them the loop sleeps in glfwWaitEventsTimeout
+    RedrawTracker& redraw = redraw_tracker();
     while (!glfwWindowShouldClose(window)) {
-        glfwPollEvents();
+        redraw.jobs(GuiJobs());
+        double timeout = redraw.timeout(glfwGetTime());
+        if (timeout > 0) {
+            glfwWaitEventsTimeout(timeout);
+        }
+        else {
+            glfwPollEvents();
+        }
+        if (!redraw.draw(glfwGetTime())) {
+            continue;
+        }
 
         int display_w, display_h;
         glfwGetFramebufferSize(window, &display_w, &display_h);
@@ -58,7 +112,14 @@ int main()
         glClearColor(clear_color.x, clear_color.y, clear_color.z, clear_color.w);
         glClear(GL_COLOR_BUFFER_BIT);
 
+        ImGui_ImplOpenGL3_NewFrame();
+        ImGui_ImplGlfw_NewFrame();
         DrawImGUI();
+        redraw.request(glfwGetTime(), ImGuiFrameDelay());
+        {
+            PROFILE_SCOPE("ImGui_ImplOpenGL3_RenderDrawData");
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        }
         glfwSwapBuffers(window);
     }
 }
@@ -1,4 +1,4 @@
-#include "gui.hpp"
+#include "window.hpp"
 
 #include "examples/imgui_impl_glfw.cpp"
 #include "examples/imgui_impl_opengl3.cpp"
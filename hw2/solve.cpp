@@ -1,4 +1,5 @@
 #include "solve.hpp"
+#include "profiler.hpp"
 
 #include <Eigen/Dense>
 
@@ -8,49 +9,6 @@
 
 using std::vector;
 
-Normalizer::Normalizer(const std::vector<Point>& points)
-    : mean_x{0}
-    , mean_y{0}
-    , std_x{0}
-    , std_y{0}
-{
-    for (const auto& p : points) {
-        mean_x += p.x;
-        mean_y += p.y;
-    }
-    mean_x /= points.size();
-    mean_y /= points.size();
-
-    for (const auto& p : points) {
-        std_x += (p.x - mean_x) * (p.x - mean_x);
-        std_y += (p.y - mean_y) * (p.y - mean_y);
-    }
-    std_x /= points.size() - 1;
-    std_y /= points.size() - 1;
-    std_x = sqrt(std_x);
-    std_y = sqrt(std_y);
-}
-
-float Normalizer::normalize_x(float x)
-{
-    return (x - mean_x) / std_x;
-}
-
-float Normalizer::normalize_y(float y)
-{
-    return (y - mean_y) / std_y;
-}
-
-float Normalizer::denormalize_x(float x)
-{
-    return x * std_x + mean_x;
-}
-
-float Normalizer::denormalize_y(float y)
-{
-    return y * std_y + mean_y;
-}
-
 SgdOptimizer::SgdOptimizer(float lr)
     : Optimizer(lr)
 {
@@ -122,7 +80,8 @@ void RBFNetwork::init(std::shared_ptr<Optimizer> opt)
             w1(r, c) = 0.2 * rand(engine);
         }
     }
-    std::cout << w1 << std::endl;
+    if (verbose)
+        std::cout << w1 << std::endl;
     b1.setZero();
 
     for (int c = 0; c < w2.cols(); c++) {
@@ -130,7 +89,8 @@ void RBFNetwork::init(std::shared_ptr<Optimizer> opt)
             w2(r, c) = 0.2 * rand(engine);
         }
     }
-    std::cout << w2.transpose() << std::endl;
+    if (verbose)
+        std::cout << w2.transpose() << std::endl;
     b2.setZero();
 
     opt->init_state(vector{&w1, &b1, &w2, &b2});
@@ -251,8 +211,10 @@ Matrixf RBFNetwork::forward_backward(std::shared_ptr<Optimizer> opt,
     return loss;
 }
 
-void RBFNetwork::fit(std::shared_ptr<Optimizer> opt, const std::vector<Point>& points)
+void RBFNetwork::fit(std::shared_ptr<Optimizer> opt, const std::vector<Point>& points,
+                     const std::function<bool()>& cancelled)
 {
+    PROFILE_SCOPE("RBFNetwork::fit");
     norm = Normalizer(points);
 
     init(opt);
@@ -266,13 +228,29 @@ void RBFNetwork::fit(std::shared_ptr<Optimizer> opt, const std::vector<Point>& p
     }
 
     for (int i = 0; i < 1000; ++i) {
+        if (cancelled && cancelled())
+            return;
         Matrixf loss = forward_backward(opt, X, Y);
-        std::cout << ">> loss: " << loss << std::endl;
+        if (verbose)
+            std::cout << ">> loss: " << loss << std::endl;
+    }
+}
+
+float RBFNetwork::evaluate(float x)
+{
+    // forward() for a single sample, without the matrices
+    float t = norm.normalize_x(x);
+    float y = b2(0, 0);
+    for (int j = 0; j < num_basis; j++) {
+        float h = t * w1(0, j) + b1(0, j);
+        y += w2(j, 0) * std::exp(-h * h);
     }
+    return norm.denormalize_y(y);
 }
 
 std::vector<Point> RBFNetwork::predict(float x_start, float x_end, int num_points)
 {
+    PROFILE_SCOPE("RBFNetwork::predict");
     auto step = (x_end - x_start) / (num_points - 1);
     float x = x_start;
 
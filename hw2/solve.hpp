@@ -1,31 +1,18 @@
 #pragma once
 
-#include "gui.hpp"
+#include "normalizer.hpp"
+#include "point.hpp"
 
 #include "Eigen/Core"
 
+#include <functional>
+#include <memory>
 #include <variant>
 #include <vector>
 
 using Matrixf = Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic>;
 using Vectorf = Eigen::Matrix<float, Eigen::Dynamic, 1>;
 
-struct Normalizer
-{
-    float mean_x;
-    float mean_y;
-    float std_x;
-    float std_y;
-    Normalizer() {}
-    Normalizer(const std::vector<Point>& points);
-
-    float normalize_x(float x);
-    float normalize_y(float y);
-
-    float denormalize_x(float x);
-    float denormalize_y(float y);
-};
-
 struct Optimizer
 {
     float lr;
@@ -72,10 +59,14 @@ struct RBFNetwork
     Matrixf b1;
     Matrixf w2;
     Matrixf b2;
+    bool verbose{true}; // print the initial weights and the loss of every step to stdout
 
     RBFNetwork(int num_basis = 0);
     void init(std::shared_ptr<Optimizer> opt);
-    void fit(std::shared_ptr<Optimizer> opt, const std::vector<Point>& points);
+    /// runs the optimizer for 1000 steps, stopping early once cancelled returns true
+    void fit(std::shared_ptr<Optimizer> opt, const std::vector<Point>& points,
+             const std::function<bool()>& cancelled = nullptr);
+    float evaluate(float x);
     std::vector<Point> predict(float x_start, float x_end, int num_points);
 
 private:
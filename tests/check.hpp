@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdio>
+
+/// Failed CHECKs of the test, main() returns nonzero if there are any
+inline int& check_failures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+/// Reports a failed condition and goes on, so that one run lists every failure
+#define CHECK(condition)                                                                           \
+    do {                                                                                           \
+        if (!(condition)) {                                                                        \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition);          \
+            check_failures()++;                                                                    \
+        }                                                                                          \
+    } while (0)
+
+/// the exit code of a test: reports the number of failed checks
+inline int check_result()
+{
+    if (check_failures()) {
+        fprintf(stderr, "%d checks failed\n", check_failures());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+// Runs jobs through AsyncResult on a pool: publishing, a job that throws, and the recovery after.
+
+#include "async_result.hpp"
+#include "check.hpp"
+
+#include <chrono>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+
+/// waits until the jobs of result are done, false if they take more than a few seconds
+template <typename T>
+bool wait_idle(const AsyncResult<T>& result)
+{
+    for (int i = 0; i < 5000 && result.busy(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return !result.busy();
+}
+
+void test_publish()
+{
+    ThreadPool pool{1};
+    AsyncResult<int> result;
+    CHECK(*result.get() == 0);
+    auto version = result.submit(pool, [](int& back, const Cancelled&) {
+        back = 42;
+        return true;
+    });
+    CHECK(wait_idle(result));
+    CHECK(*result.get() == 42);
+    CHECK(result.published() == version);
+    CHECK(result.error().empty());
+}
+
+void test_throwing_job()
+{
+    ThreadPool pool{1};
+    AsyncResult<int> result;
+    result.submit(pool, [](int& back, const Cancelled&) {
+        back = 1;
+        return true;
+    });
+    CHECK(wait_idle(result));
+    auto version = result.submit(pool, [](int& back, const Cancelled&) -> bool {
+        back = 2;
+        throw std::runtime_error("matrix too large");
+    });
+    CHECK(wait_idle(result));
+    CHECK(result.published() == version);
+    CHECK(result.error() == "matrix too large");
+    // the result of the failed job is not published
+    CHECK(*result.get() == 1);
+
+    result.submit(pool, [](int&, const Cancelled&) -> bool { throw std::bad_alloc(); });
+    CHECK(wait_idle(result));
+    CHECK(!result.error().empty());
+    CHECK(*result.get() == 1);
+
+    result.submit(pool, [](int&, const Cancelled&) -> bool { throw 7; });
+    CHECK(wait_idle(result));
+    CHECK(result.error() == "unknown error");
+
+    // a job that succeeds again clears the error
+    version = result.submit(pool, [](int& back, const Cancelled&) {
+        back = 3;
+        return true;
+    });
+    CHECK(wait_idle(result));
+    CHECK(result.published() == version);
+    CHECK(result.error().empty());
+    CHECK(*result.get() == 3);
+}
+
+void test_cancelled_job()
+{
+    ThreadPool pool{1};
+    AsyncResult<int> result;
+    // the first job holds the pool until the second one has been submitted, which cancels it
+    std::atomic<bool> release{false};
+    result.submit(pool, [&](int& back, const Cancelled& cancelled) {
+        while (!release) {
+            std::this_thread::yield();
+        }
+        back = 1;
+        return !cancelled();
+    });
+    auto version = result.submit(pool, [](int& back, const Cancelled&) {
+        back = 2;
+        return true;
+    });
+    release = true;
+    CHECK(wait_idle(result));
+    CHECK(result.published() == version);
+    CHECK(*result.get() == 2);
+}
+
+} // namespace
+
+int main()
+{
+    test_publish();
+    test_throwing_job();
+    test_cancelled_job();
+    return check_result();
+}
@@ -0,0 +1,117 @@
+// Checks ChebyshevSeries against polynomials with known values, derivatives, integrals and roots.
+
+#include "check.hpp"
+#include "hw1/solve.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+
+const double PI = 3.14159265358979323846;
+
+bool near(double a, double b, double tolerance = 1e-4)
+{
+    return std::abs(a - b) <= tolerance * std::max(1.0, std::abs(b));
+}
+
+bool same_roots(const std::vector<float>& roots, std::vector<double> expected)
+{
+    if (roots.size() != expected.size()) {
+        return false;
+    }
+    std::sort(expected.begin(), expected.end());
+    for (size_t i = 0; i < roots.size(); i++) {
+        if (!near(roots[i], expected[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+double cubic(double x)
+{
+    return x * x * x - 2 * x + 1;
+}
+
+void test_evaluate()
+{
+    ChebyshevSeries series(cubic, 3, -2, 3);
+    CHECK(series.degree() == 3);
+    for (double x = -2; x <= 3; x += 0.25) {
+        CHECK(near(series.evaluate(static_cast<float>(x)), cubic(x)));
+    }
+    auto points = series.predict(-2, 3, 11);
+    CHECK(points.size() == 11);
+    CHECK(near(points[10].x, 3) && near(points[10].y, cubic(3)));
+}
+
+void test_derivative_and_integral()
+{
+    ChebyshevSeries series([](double x) { return x * x * x; }, 3, 0, 2);
+    auto d = series.derivative();
+    auto dd = d.derivative();
+    auto i = series.integral();
+    for (double x = 0; x <= 2; x += 0.125) {
+        float xf = static_cast<float>(x);
+        CHECK(near(d.evaluate(xf), 3 * x * x));
+        CHECK(near(dd.evaluate(xf), 6 * x));
+        CHECK(near(i.evaluate(xf), x * x * x * x / 4));
+    }
+    // the derivative of the integral gives the series back
+    auto back = i.derivative();
+    CHECK(near(back.evaluate(1.5f), 1.5 * 1.5 * 1.5));
+}
+
+void test_roots()
+{
+    // the roots of T_n are cos((2k - 1) pi / 2n)
+    for (int n : {1, 2, 5, 8}) {
+        ChebyshevSeries t_n([n](double x) { return std::cos(n * std::acos(x)); }, n, -1, 1);
+        std::vector<double> expected;
+        for (int k = 1; k <= n; k++) {
+            expected.push_back(std::cos((2 * k - 1) * PI / (2 * n)));
+        }
+        CHECK(same_roots(t_n.roots(), expected));
+    }
+
+    // roots on a shifted interval, one of them outside it
+    ChebyshevSeries shifted([](double x) { return (x - 3) * (x - 4) * (x - 5.5) * (x - 9); }, 4, 2,
+                            6);
+    CHECK(same_roots(shifted.roots(), {3, 4, 5.5}));
+
+    // x^3 - 3x has its extrema at -1 and 1
+    ChebyshevSeries odd([](double x) { return x * x * x - 3 * x; }, 3, -2, 2);
+    CHECK(same_roots(odd.extrema(), {-1, 1}));
+}
+
+void test_from_least_square()
+{
+    // a least square fit of points on a quadratic is the quadratic, whatever its basis
+    std::vector<Point> points;
+    for (int i = 0; i < 20; i++) {
+        float x = 10.0f + i;
+        points.push_back({x, 0.5f * (x - 15) * (x - 15) - 3});
+    }
+    ChebyshevSeries from_monomial(LeastSquare(2, points), 10, 29);
+    ChebyshevSeries from_orthogonal(OrthogonalLeastSquare(2, points), 10, 29);
+    for (float x : {10.0f, 14.5f, 22.0f, 29.0f}) {
+        double y = 0.5 * (x - 15) * (x - 15) - 3;
+        CHECK(near(from_monomial.evaluate(x), y, 1e-3));
+        CHECK(near(from_orthogonal.evaluate(x), y, 1e-3));
+    }
+    CHECK(same_roots(from_orthogonal.roots(), {15 - std::sqrt(6.0), 15 + std::sqrt(6.0)}));
+}
+
+} // namespace
+
+int main()
+{
+    test_evaluate();
+    test_derivative_and_integral();
+    test_roots();
+    test_from_least_square();
+    return check_result();
+}
@@ -0,0 +1,80 @@
+// Checks that the matrix-free Gauss interpolation solves the same interpolant as the dense one.
+
+#include "check.hpp"
+#include "hw1/solve.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+/// Points with distinct xs in a shuffled order, which the CG path has to sort
+std::vector<Point> make_points(int n, float spacing)
+{
+    std::mt19937 engine{102};
+    std::uniform_real_distribution<float> jitter{-0.3f, 0.3f};
+    std::vector<Point> points;
+    for (int i = 0; i < n; i++) {
+        float x = (i + jitter(engine)) * spacing;
+        points.push_back({x, 300 + 100 * std::sin(x / 40)});
+    }
+    std::shuffle(points.begin(), points.end(), engine);
+    return points;
+}
+
+/// The largest difference of the two curves over the range of the points
+float max_difference(GaussInterpolation& a, GaussInterpolation& b, float x_end)
+{
+    auto ya = a.predict(0, x_end, 301);
+    auto yb = b.predict(0, x_end, 301);
+    float diff = 0;
+    for (size_t i = 0; i < ya.size(); i++) {
+        diff = std::max(diff, std::abs(ya[i].y - yb[i].y));
+    }
+    return diff;
+}
+
+void test_same_interpolant()
+{
+    // below the spacing, sigma keeps the kernel matrix and the Schur complement of the constant
+    // term well conditioned in float, so both solvers reach the interpolant closely
+    const int n = 60;
+    const float spacing = 10;
+    auto points = make_points(n, spacing);
+    GaussInterpolation dense(6, points);
+
+    IterativeOptions opts;
+    opts.tol = 1e-6f;
+    GaussInterpolation cg(6, points, opts);
+    CHECK(cg.residual <= 1e-5f);
+    CHECK(std::abs(cg.coeff(0) - dense.coeff(0)) <= 0.01f);
+    CHECK(max_difference(dense, cg, n * spacing) <= 0.01f);
+
+    // both go through the points
+    for (const auto& p : points) {
+        CHECK(std::abs(cg.evaluate(p.x) - p.y) <= 0.01f);
+    }
+}
+
+void test_few_points()
+{
+    std::vector<Point> one{{5, 7}};
+    GaussInterpolation cg(10, one, IterativeOptions{});
+    CHECK(cg.evaluate(-100) == 7 && cg.evaluate(5) == 7);
+
+    std::vector<Point> none;
+    GaussInterpolation empty(10, none, IterativeOptions{});
+    CHECK(std::isnan(empty.coeff(0)));
+}
+
+} // namespace
+
+int main()
+{
+    test_same_interpolant();
+    test_few_points();
+    return check_result();
+}
@@ -0,0 +1,118 @@
+// Checks the float and double instantiations of the least square and ridge fits against a
+// polynomial they can fit exactly, and their constructors against each other.
+
+#include "check.hpp"
+#include "hw1/solve.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+
+bool near(double a, double b, double tolerance)
+{
+    return std::abs(a - b) <= tolerance * std::max(1.0, std::abs(b));
+}
+
+double cubic(double x)
+{
+    return 0.002 * (x - 40) * (x - 10) * (x - 70) + 5;
+}
+
+std::vector<Point> cubic_points(int n)
+{
+    std::vector<Point> points;
+    for (int i = 0; i < n; i++) {
+        float x = 80.0f * i / (n - 1);
+        points.push_back({x, static_cast<float>(cubic(x))});
+    }
+    return points;
+}
+
+template <typename Solver>
+bool fits_cubic(Solver& solver, double tolerance)
+{
+    auto curve = solver.predict(0, 80, 17);
+    for (const auto& p : curve) {
+        if (!near(p.y, cubic(p.x), tolerance)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void test_scalars()
+{
+    auto points = cubic_points(200);
+    BasicLeastSquare<float> ls_float(3, points);
+    LeastSquare ls_double(3, points);
+    CHECK(fits_cubic(ls_float, 1e-2));
+    CHECK(fits_cubic(ls_double, 1e-4));
+
+    // with no weight ridge is least square
+    BasicRidgeRegression<float> rr_float(3, 0, points);
+    RidgeRegression rr_double(3, 0, points);
+    CHECK(fits_cubic(rr_float, 1e-2));
+    CHECK(fits_cubic(rr_double, 1e-4));
+    for (float x : {0.0f, 33.0f, 80.0f}) {
+        CHECK(near(rr_float.evaluate(x), rr_double.evaluate(x), 1e-2));
+    }
+
+    // orders past MAX_FIXED_ORDER take the dynamic path
+    LeastSquare high(MAX_FIXED_ORDER + 2, points);
+    CHECK(fits_cubic(high, 1e-2));
+}
+
+void test_constructors()
+{
+    auto points = cubic_points(1000);
+    LeastSquare in_memory(3, points);
+
+    StreamOptions opts;
+    opts.num_threads = 3;
+    opts.chunk_size = 64;
+    LeastSquare streamed(3, points.begin(), points.end(), opts);
+    CHECK(fits_cubic(streamed, 1e-4));
+
+    // a pool of the caller's serves fit after fit
+    ThreadPool pool{2};
+    opts.pool = &pool;
+    for (int i = 0; i < 3; i++) {
+        LeastSquare pooled(3, points.begin(), points.end(), opts);
+        CHECK(fits_cubic(pooled, 1e-4));
+    }
+
+    Eigen::VectorXf xs(points.size());
+    Eigen::VectorXf ys(points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+        xs(i) = points[i].x;
+        ys(i) = points[i].y;
+    }
+    BasicLeastSquare<float> columns(3, xs, ys, Normalizer(points), opts);
+    CHECK(fits_cubic(columns, 1e-4));
+
+    for (float x : {0.0f, 21.0f, 80.0f}) {
+        CHECK(near(streamed.predict(x, x + 1, 2)[0].y, in_memory.predict(x, x + 1, 2)[0].y, 1e-4));
+    }
+}
+
+void test_empty()
+{
+    std::vector<Point> none;
+    BasicLeastSquare<float> ls(2, none);
+    CHECK(ls.coeff.size() == 3 && std::isnan(ls.coeff(0)));
+    RidgeRegression rr(-1, 0.1f, cubic_points(10));
+    CHECK(rr.coeff.size() == 1 && std::isnan(rr.coeff(0)));
+}
+
+} // namespace
+
+int main()
+{
+    test_scalars();
+    test_constructors();
+    test_empty();
+    return check_result();
+}
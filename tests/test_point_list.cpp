@@ -0,0 +1,70 @@
+// Checks that snapshots of a PointList keep the points they were taken of while the list is
+// edited, and that the list only copies its points when a snapshot still shares them.
+
+#include "check.hpp"
+#include "point_list.hpp"
+
+#include <vector>
+
+namespace
+{
+
+bool same(const std::vector<Point>& a, const std::vector<Point>& b)
+{
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].x != b[i].x || a[i].y != b[i].y) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void test_snapshot_survives_edits()
+{
+    PointList list;
+    list.assign({{1, 1}, {2, 2}, {3, 3}});
+    auto before = list.snapshot();
+    CHECK(before.get() == &list.points());
+
+    uint32_t id = list.add({4, 4});
+    CHECK(before.get() != &list.points());
+    CHECK(same(*before, {{1, 1}, {2, 2}, {3, 3}}));
+
+    auto after_add = list.snapshot();
+    list.remove(0);
+    CHECK(same(*after_add, {{1, 1}, {2, 2}, {3, 3}, {4, 4}}));
+    CHECK(same(list.points(), {{4, 4}, {2, 2}, {3, 3}}));
+    CHECK(list.index(id) == 0);
+
+    auto after_remove = list.snapshot();
+    list.clear();
+    CHECK(list.empty() && after_remove->size() == 3);
+}
+
+void test_no_copy_without_snapshot()
+{
+    PointList list;
+    list.add({1, 1});
+    const std::vector<Point>* points = &list.points();
+    list.add({2, 2});
+    list.remove(0);
+    CHECK(&list.points() == points);
+
+    // a released snapshot no longer holds the points back
+    list.snapshot();
+    list.add({3, 3});
+    CHECK(&list.points() == points);
+    CHECK(same(list.points(), {{2, 2}, {3, 3}}));
+}
+
+} // namespace
+
+int main()
+{
+    test_snapshot_survives_edits();
+    test_no_copy_without_snapshot();
+    return check_result();
+}
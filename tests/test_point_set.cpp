@@ -0,0 +1,156 @@
+// Checks the incremental statistics, sorted index and closest pair of PointSet against a batch
+// recomputation over the points, after every edit of a random sequence of inserts and erases.
+
+#include "check.hpp"
+#include "point.hpp"
+#include "point_set.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+bool near(double a, double b)
+{
+    return std::abs(a - b) <= 1e-6 * std::max(1.0, std::abs(b));
+}
+
+/// The statistics, index and gaps of set recomputed from its arrays
+bool matches_batch(const PointSet& set)
+{
+    const size_t n = set.size();
+    double mean_x = 0;
+    double mean_y = 0;
+    for (size_t i = 0; i < n; i++) {
+        mean_x += set.x(i);
+        mean_y += set.y(i);
+    }
+    mean_x = n ? mean_x / n : 0;
+    mean_y = n ? mean_y / n : 0;
+    double var_x = 0;
+    double var_y = 0;
+    for (size_t i = 0; i < n; i++) {
+        var_x += (set.x(i) - mean_x) * (set.x(i) - mean_x);
+        var_y += (set.y(i) - mean_y) * (set.y(i) - mean_y);
+    }
+    var_x = n > 1 ? var_x / (n - 1) : 0;
+    var_y = n > 1 ? var_y / (n - 1) : 0;
+    if (!near(set.mean_x(), mean_x) || !near(set.mean_y(), mean_y) ||
+        !near(set.var_x(), var_x) || !near(set.var_y(), var_y)) {
+        return false;
+    }
+
+    // the index is a permutation in ascending x
+    auto index = set.sorted_index();
+    auto sorted = index;
+    std::sort(sorted.begin(), sorted.end());
+    for (size_t i = 0; i < sorted.size(); i++) {
+        if (sorted[i] != i) {
+            return false;
+        }
+    }
+    for (size_t i = 1; i < index.size(); i++) {
+        if (set.x(index[i - 1]) > set.x(index[i])) {
+            return false;
+        }
+    }
+
+    std::vector<float> xs(n);
+    for (size_t i = 0; i < n; i++) {
+        xs[i] = set.x(i);
+    }
+    std::sort(xs.begin(), xs.end());
+    float min_gap = INFINITY;
+    for (size_t i = 1; i < n; i++) {
+        min_gap = std::min(min_gap, xs[i] - xs[i - 1]);
+    }
+    if (set.min_gap() != min_gap) {
+        return false;
+    }
+    if (n >= 2) {
+        auto [a, b] = set.closest_pair();
+        if (a >= n || b >= n || set.x(b) - set.x(a) != min_gap) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void test_random_edits()
+{
+    std::mt19937 engine{102};
+    std::uniform_real_distribution<float> coordinate{0, 1000};
+    PointSet set;
+    for (int step = 0; step < 2000; step++) {
+        // inserts outweigh erases, so the set grows and shrinks back to empty now and then
+        if (set.empty() || engine() % 5 < 3) {
+            set.push_back(coordinate(engine), coordinate(engine));
+        }
+        else {
+            set.erase(engine() % set.size());
+        }
+        if (step % 7 == 0 && !matches_batch(set)) {
+            CHECK(matches_batch(set));
+            return;
+        }
+    }
+    CHECK(matches_batch(set));
+
+    while (!set.empty()) {
+        set.erase(set.size() - 1);
+    }
+    CHECK(matches_batch(set));
+}
+
+void test_duplicate_xs()
+{
+    // equal xs give gaps of zero that have to be told apart by their indices
+    PointSet set;
+    for (float x : {3.0f, 1.0f, 3.0f, 2.0f, 3.0f}) {
+        set.push_back(x, x * 2);
+    }
+    CHECK(set.min_gap() == 0);
+    CHECK(matches_batch(set));
+    set.erase(0);
+    CHECK(set.min_gap() == 0);
+    CHECK(matches_batch(set));
+    set.erase(3);
+    CHECK(matches_batch(set));
+}
+
+void test_erase_out_of_range()
+{
+    PointSet set;
+    set.erase(0);
+    CHECK(set.empty() && matches_batch(set));
+
+    set.push_back(1, 2);
+    set.erase(1);
+    CHECK(set.size() == 1 && set.x(0) == 1);
+    set.erase(0);
+    CHECK(set.empty() && set.mean_x() == 0 && set.var_x() == 0);
+}
+
+void test_maps()
+{
+    std::vector<Point> points{{4, 1}, {2, 3}, {8, 5}};
+    PointSet set(points.begin(), points.end());
+    auto xs = set.x_map();
+    auto ys = set.y_map();
+    CHECK(xs.size() == 3 && ys.size() == 3);
+    CHECK(xs(0) == 4 && xs(2) == 8 && ys(1) == 3);
+}
+
+} // namespace
+
+int main()
+{
+    test_random_edits();
+    test_duplicate_xs();
+    test_erase_out_of_range();
+    test_maps();
+    return check_result();
+}
@@ -0,0 +1,119 @@
+// Drives the decisions of RedrawTracker with a fake clock: the frames that are due after input,
+// published job results and requests, the waits in between and the always-redraw toggle.
+
+#include "check.hpp"
+#include "redraw_tracker.hpp"
+
+#include <cmath>
+
+namespace
+{
+
+bool near(double a, double b)
+{
+    return std::abs(a - b) < 1e-9;
+}
+
+/// draws the frames due at now, returns how many
+int drain(RedrawTracker& tracker, double now)
+{
+    int frames = 0;
+    while (tracker.draw(now) && frames < 100) {
+        frames++;
+    }
+    return frames;
+}
+
+void test_startup_settles_then_idles()
+{
+    RedrawTracker tracker;
+    CHECK(tracker.timeout(0) == 0);
+    CHECK(drain(tracker, 0) == RedrawTracker::SETTLE_FRAMES);
+    CHECK(near(tracker.timeout(0), RedrawTracker::IDLE_WAIT));
+    CHECK(!tracker.draw(0.5));
+    CHECK(tracker.drawn_frames() == RedrawTracker::SETTLE_FRAMES);
+    CHECK(tracker.skipped_frames() == 2);
+}
+
+void test_input_draws_settle_frames()
+{
+    RedrawTracker tracker;
+    drain(tracker, 0);
+    tracker.input();
+    CHECK(tracker.timeout(1) == 0);
+    CHECK(drain(tracker, 1) == RedrawTracker::SETTLE_FRAMES);
+    // input in the middle of settling starts over
+    tracker.input();
+    CHECK(tracker.draw(2));
+    tracker.input();
+    CHECK(drain(tracker, 2) == RedrawTracker::SETTLE_FRAMES);
+}
+
+void test_request_deadline()
+{
+    RedrawTracker tracker;
+    drain(tracker, 0);
+    tracker.request(10, 0.5);
+    CHECK(near(tracker.timeout(10), 0.5));
+    CHECK(near(tracker.timeout(10.25), 0.25));
+    CHECK(!tracker.draw(10.25));
+    // the earliest of several requests counts
+    tracker.request(10.25, 2);
+    CHECK(near(tracker.timeout(10.25), 0.25));
+    CHECK(tracker.draw(10.5));
+    // a drawn frame clears the request
+    CHECK(!tracker.draw(20));
+    CHECK(near(tracker.timeout(20), RedrawTracker::IDLE_WAIT));
+    // an overdue request does not wait
+    tracker.request(30, 0);
+    CHECK(tracker.timeout(31) == 0);
+    CHECK(tracker.draw(31));
+}
+
+void test_jobs_poll_and_publish()
+{
+    RedrawTracker tracker;
+    drain(tracker, 0);
+    tracker.jobs({true, 0});
+    CHECK(near(tracker.timeout(1), RedrawTracker::JOB_POLL));
+    CHECK(!tracker.draw(1));
+    // a result published and finished between two polls still draws a frame
+    tracker.jobs({false, 1});
+    CHECK(tracker.draw(1.1));
+    CHECK(!tracker.draw(1.2));
+    CHECK(near(tracker.timeout(1.2), RedrawTracker::IDLE_WAIT));
+    // the same count again is no new result
+    tracker.jobs({false, 1});
+    CHECK(!tracker.draw(1.3));
+    // a result published while another job is running draws as well
+    tracker.jobs({true, 2});
+    CHECK(tracker.draw(1.4));
+    CHECK(near(tracker.timeout(1.4), RedrawTracker::JOB_POLL));
+}
+
+void test_always_redraw()
+{
+    RedrawTracker tracker;
+    drain(tracker, 0);
+    tracker.set_always_redraw(true);
+    CHECK(tracker.always_redraw());
+    CHECK(tracker.timeout(1) == 0);
+    for (int i = 0; i < 10; i++) {
+        CHECK(tracker.draw(1 + i * 0.01));
+    }
+    tracker.set_always_redraw(false);
+    CHECK(!tracker.draw(2));
+    CHECK(near(tracker.timeout(2), RedrawTracker::IDLE_WAIT));
+}
+
+} // namespace
+
+int main()
+{
+    test_startup_settles_then_idles();
+    test_input_draws_settle_frames();
+    test_request_deadline();
+    test_jobs_poll_and_publish();
+    test_always_redraw();
+    return check_result();
+}